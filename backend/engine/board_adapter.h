@@ -1,46 +1,224 @@
 // board_adapter.h
 #pragma once
 #include "virgo/virgo.h"
+#include "nnue.h"
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <cmath>
 #include <unordered_set>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace board_adapter {
 
+inline int pop_count(uint64_t bb) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(bb));
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
+inline int lsb_index(uint64_t bb) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bb);
+#endif
+}
+
+constexpr uint64_t FILE_A_MASK = 0x0101010101010101ull;
+constexpr uint64_t FILE_H_MASK = 0x8080808080808080ull;
+
+inline uint64_t file_mask(int file) {
+    return FILE_A_MASK << file;
+}
+
+inline uint64_t adjacent_files_mask(int file) {
+    return ((file > 0) ? file_mask(file - 1) : 0) | ((file < 7) ? file_mask(file + 1) : 0);
+}
+
+// Squares strictly in front of a square from the given side's point of view
+inline uint64_t forward_ranks_mask(virgo::Player side, int square) {
+    int rank = square >> 3;
+    if (side == virgo::WHITE) return (rank == 7) ? 0 : (~0ull << (8 * (rank + 1)));
+    return (rank == 0) ? 0 : ((1ull << (8 * rank)) - 1);
+}
+
+inline uint64_t pawn_attacks_mask(virgo::Player side, uint64_t pawns) {
+    if (side == virgo::WHITE) return ((pawns & ~FILE_A_MASK) << 7) | ((pawns & ~FILE_H_MASK) << 9);
+    return ((pawns & ~FILE_A_MASK) >> 9) | ((pawns & ~FILE_H_MASK) >> 7);
+}
+
+// Pawn structure scores only depend on the pawns, so they are cached by the
+// pawn Zobrist key. One table per thread, direct mapped.
+struct PawnHashTable {
+    static constexpr size_t SIZE = 1 << 14;
+
+    struct Entry {
+        uint64_t key;
+        int score;
+    };
+
+    Entry entries[SIZE] = {};
+
+    Entry &probe(uint64_t key) {
+        return entries[key & (SIZE - 1)];
+    }
+};
+
+inline thread_local PawnHashTable pawn_table;
+
+// Static evaluations by Zobrist key, shared by every search thread. Entries
+// hold the key xor'ed with the data, so a half-written entry reads as a miss.
+struct EvalCache {
+    static constexpr size_t SIZE = 1 << 16;
+    static constexpr uint64_t NNUE_SALT = 0x5bd1e9955bd1e995ull;
+
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    Entry entries[SIZE];
+
+    bool probe(uint64_t key, int &eval) {
+        Entry &entry = entries[key & (SIZE - 1)];
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key) return false;
+        eval = static_cast<int32_t>(static_cast<uint32_t>(data));
+        return true;
+    }
+
+    void store(uint64_t key, int eval) {
+        Entry &entry = entries[key & (SIZE - 1)];
+        uint64_t data = static_cast<uint32_t>(eval);
+        entry.data.store(data, std::memory_order_relaxed);
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+    }
+};
+
+inline EvalCache eval_cache;
+
+// Cuckoo tables holding the Zobrist difference of every reversible piece
+// move on an empty board, so a move that returns to an earlier position can
+// be found from two keys without making it
+struct CuckooTables {
+    static constexpr int SIZE = 8192;
+
+    uint64_t keys[SIZE];
+    uint16_t moves[SIZE]; // from | to << 6, 0 when empty
+
+    static int h1(uint64_t key) { return key & 0x1fff; }
+    static int h2(uint64_t key) { return (key >> 16) & 0x1fff; }
+
+    // Needs the virgo Zobrist keys, so call after virgo_init
+    void init() {
+        static const virgo::Piece pieces[5] = {virgo::KNIGHT, virgo::BISHOP, virgo::ROOK, virgo::QUEEN, virgo::KING};
+
+        std::fill(keys, keys + SIZE, 0);
+        std::fill(moves, moves + SIZE, 0);
+
+        for (int color = 0; color < 2; color++) {
+            for (virgo::Piece piece : pieces) {
+                for (int s1 = 0; s1 < 64; s1++) {
+                    for (int s2 = s1 + 1; s2 < 64; s2++) {
+                        if (!empty_board_attack(piece, s1, s2)) continue;
+
+                        uint16_t move = static_cast<uint16_t>(s1 | (s2 << 6));
+                        uint64_t key = ZOBRIST_PIECE[color][piece][s1] ^ ZOBRIST_PIECE[color][piece][s2] ^ ZOBRIST_SIDE;
+                        int i = h1(key);
+                        while (true) {
+                            std::swap(keys[i], key);
+                            std::swap(moves[i], move);
+                            if (move == 0) break;
+                            i = (i == h1(key)) ? h2(key) : h1(key);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    static bool empty_board_attack(virgo::Piece piece, int s1, int s2) {
+        bool same_line = (s1 & 7) == (s2 & 7) || (s1 >> 3) == (s2 >> 3);
+        bool same_diagonal = LINE_MASK[s1][s2] != 0 && !same_line;
+        switch (piece) {
+            case virgo::KNIGHT: return KNIGHT_ATTACKS[s1] & (1ull << s2);
+            case virgo::KING: return KING_ATTACKS[s1] & (1ull << s2);
+            case virgo::BISHOP: return same_diagonal;
+            case virgo::ROOK: return same_line;
+            case virgo::QUEEN: return same_line || same_diagonal;
+            default: return false;
+        }
+    }
+};
+
+inline CuckooTables cuckoo;
+
 struct Position {
     virgo::Chessboard board;
     bool whiteToMove;
-    std::vector<uint64_t> positionHistory; // track for repetitions
+    nnue::AccumulatorStack accumulators;
+    std::vector<int> nullMoves; // board history sizes right after each null move
+    virgo::AttackInfo attackInfo;
+    uint64_t attackInfoKey = 0; // key of the position attackInfo was computed for
+
+    static constexpr size_t NULL_MOVES_RESERVE = 64;
 
     Position(const std::string &fen) {
         board = virgo::position_from_fen(fen.c_str());
         whiteToMove = board.get_next_to_move() == virgo::WHITE;
-        positionHistory.push_back(hash_position());
+        nullMoves.reserve(NULL_MOVES_RESERVE);
     }
 
     virgo::Player get_next_to_move() {
         return board.get_next_to_move();
     }
 
+    // Attack maps, pins and checkers of the current position, computed once per position:
+    // the generator, check detection, mobility, SEE and king safety all share them
+    const virgo::AttackInfo &attacks() {
+        uint64_t key = board.get_key();
+        if (attackInfoKey != key || key == 0) {
+            if (board.get_next_to_move() == virgo::WHITE) {
+                virgo::get_attack_info<virgo::WHITE>(board, attackInfo);
+            } else {
+                virgo::get_attack_info<virgo::BLACK>(board, attackInfo);
+            }
+            attackInfoKey = key;
+        }
+        return attackInfo;
+    }
+
     std::vector<uint16_t> get_legal_moves() {
+        const virgo::AttackInfo &info = attacks();
         std::vector<uint16_t> moves;
         if (board.get_next_to_move() == virgo::WHITE) {
-            virgo::get_legal_moves<virgo::WHITE>(board, moves);
+            virgo::get_legal_moves<virgo::WHITE>(board, info, moves);
         } else {
-            virgo::get_legal_moves<virgo::BLACK>(board, moves);
+            virgo::get_legal_moves<virgo::BLACK>(board, info, moves);
         }
         return moves;
     }
 
     void make_move(uint16_t move) {
+        if (nnue::enabled) {
+            accumulators.push(board, move);
+        }
         if (board.get_next_to_move() == virgo::WHITE) {
             virgo::make_move<virgo::WHITE>(move, board);
         } else {
             virgo::make_move<virgo::BLACK>(move, board);
         }
         whiteToMove = !whiteToMove;
-        positionHistory.push_back(hash_position());
     }
 
     void undo_move() {
@@ -50,52 +228,195 @@ struct Position {
             virgo::take_move<virgo::BLACK>(board);
         }
         whiteToMove = !whiteToMove;
-        if (!positionHistory.empty()) {
-            positionHistory.pop_back();
+        if (nnue::enabled) {
+            accumulators.pop();
         }
     }
 
-    uint64_t hash_position() {
-        uint64_t hash = 0;
+    // Passes the turn; only used by null-move pruning, never with the side to move in check
+    void make_null_move() {
+        if (nnue::enabled) {
+            accumulators.push_null();
+        }
+        virgo::make_null_move(board);
+        whiteToMove = !whiteToMove;
+        nullMoves.push_back(static_cast<int>(board.get_history_size()));
+    }
 
-        for (int square = 0; square < 64; square++) {
-            auto piece = board[square];
-            if (piece.first != virgo::EMPTY) {
-                uint64_t piece_hash = (static_cast<uint64_t>(piece.first) << 8) | 
-                                    (static_cast<uint64_t>(piece.second) << 4) | 
-                                    square;
-                hash ^= piece_hash * 0x9e3779b97f4a7c15ull;
-            }
+    void undo_null_move() {
+        virgo::take_null_move(board);
+        whiteToMove = !whiteToMove;
+        nullMoves.pop_back();
+        if (nnue::enabled) {
+            accumulators.pop();
         }
+    }
 
-        hash ^= (board.get_next_to_move() == virgo::WHITE) ? 0x123456789abcdef0ull : 0x0fedcba987654321ull;
-        
-        return hash;
+    // How far back a repetition can be found: not past the last capture or
+    // pawn move, nor past a null move
+    int repetition_window() {
+        int last = static_cast<int>(board.get_history_size());
+        int end = std::min(static_cast<int>(board.get_fifty_mv_counter()), last);
+        if (!nullMoves.empty()) {
+            end = std::min(end, last - nullMoves.back());
+        }
+        return end;
     }
 
+    uint64_t hash_position() {
+        return board.get_key();
+    }
+
+    // Only positions since the last capture or pawn move can repeat, and only
+    // with the same side to move, so walk back two plies at a time from four
     bool is_repetition_draw(int max_repetitions = 3) {
-        if (positionHistory.empty()) return false;
-        
-        uint64_t current_hash = positionHistory.back();
-        int count = 0;
+        int end = repetition_window();
+        uint64_t current_hash = hash_position();
+        int count = 1;
 
-        for (auto hash : positionHistory) {
-            if (hash == current_hash) {
+        for (int i = 4; i <= end; i += 2) {
+            if (board.get_history_key(i) == current_hash) {
                 count++;
                 if (count >= max_repetitions) {
                     return true;
                 }
             }
         }
-        
+
         return false;
     }
 
-    bool would_cause_repetition(uint16_t move, int max_repetitions = 2) {
-        make_move(move);
-        bool causes_repetition = is_repetition_draw(max_repetitions);
-        undo_move();
-        return causes_repetition;
+    // Whether the side to move has a reversible move back to a position
+    // already on the line; square1/square2 are the squares of that move
+    bool upcoming_repetition(int &square1, int &square2) {
+        int end = repetition_window();
+        if (end < 3) return false;
+
+        uint64_t original = hash_position();
+        for (int i = 3; i <= end; i += 2) {
+            uint64_t move_key = original ^ board.get_history_key(i);
+            int j = CuckooTables::h1(move_key);
+            if (cuckoo.keys[j] != move_key) {
+                j = CuckooTables::h2(move_key);
+                if (cuckoo.keys[j] != move_key) continue;
+            }
+
+            int s1 = cuckoo.moves[j] & 0x3f;
+            int s2 = cuckoo.moves[j] >> 6;
+            uint64_t between = LINE_MASK[s1][s2] ? (FROM_TO_MASK[s1][s2] ^ (1ull << s1) ^ (1ull << s2)) : 0;
+            if (between & board.occupancy()) continue;
+
+            int occupied_square = board.piece_on(s1) == virgo::EMPTY ? s2 : s1;
+            if (board.color_on(occupied_square) != board.get_next_to_move()) continue;
+
+            square1 = s1;
+            square2 = s2;
+            return true;
+        }
+        return false;
+    }
+
+    // Pieces of both sides attacking a square, given an occupancy
+    uint64_t attackers_to(int square, uint64_t occupied) {
+        uint64_t queens = board.get_bitboard<virgo::WHITE>(virgo::QUEEN) | board.get_bitboard<virgo::BLACK>(virgo::QUEEN);
+        uint64_t diagonal = board.get_bitboard<virgo::WHITE>(virgo::BISHOP) | board.get_bitboard<virgo::BLACK>(virgo::BISHOP) | queens;
+        uint64_t orthogonal = board.get_bitboard<virgo::WHITE>(virgo::ROOK) | board.get_bitboard<virgo::BLACK>(virgo::ROOK) | queens;
+
+        return (moves::get_pawns_attacks_to<virgo::WHITE>(square) & board.get_bitboard<virgo::WHITE>(virgo::PAWN)) |
+               (moves::get_pawns_attacks_to<virgo::BLACK>(square) & board.get_bitboard<virgo::BLACK>(virgo::PAWN)) |
+               (KNIGHT_ATTACKS[square] & (board.get_bitboard<virgo::WHITE>(virgo::KNIGHT) | board.get_bitboard<virgo::BLACK>(virgo::KNIGHT))) |
+               (KING_ATTACKS[square] & (board.get_bitboard<virgo::WHITE>(virgo::KING) | board.get_bitboard<virgo::BLACK>(virgo::KING))) |
+               (moves::diagonal_attacks(occupied, square) & diagonal) |
+               (moves::orthogonal_attacks(occupied, square) & orthogonal);
+    }
+
+    // Static exchange evaluation: material balance of the capture sequence on
+    // the target square, each side recapturing with its least valuable piece.
+    // Sliders behind a piece that has captured join in as x-rays.
+    int see(uint16_t move) {
+        // Indexed by virgo::Piece: PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN, EMPTY
+        static const int values[7] = {100, 500, 320, 330, 20000, 900, 0};
+        static const virgo::Piece promoted[4] = {virgo::ROOK, virgo::BISHOP, virgo::QUEEN, virgo::KNIGHT};
+        // Least valuable first
+        static const virgo::Piece order[6] = {virgo::PAWN, virgo::KNIGHT, virgo::BISHOP, virgo::ROOK, virgo::QUEEN, virgo::KING};
+
+        int from = MOVE_FROM(move);
+        int to = MOVE_TO(move);
+        int type = MOVE_TYPE(move);
+        if (type == virgo::CASTLE) return 0;
+
+        uint64_t occupied = board.occupancy() ^ (1ull << from);
+        virgo::Piece attacker = board.piece_on(from);
+        int gain[32];
+        gain[0] = values[board.piece_on(to)];
+
+        if (type == virgo::EN_PASSANT) {
+            gain[0] = values[virgo::PAWN];
+            occupied ^= 1ull << (board.color_on(from) == virgo::WHITE ? to - 8 : to + 8);
+        } else if (type >= virgo::PQ_R) {
+            attacker = promoted[(type - virgo::PQ_R) % 4];
+            gain[0] += values[attacker] - values[virgo::PAWN];
+        }
+
+        uint64_t diagonal = board.get_bitboard<virgo::WHITE>(virgo::BISHOP) | board.get_bitboard<virgo::BLACK>(virgo::BISHOP) |
+                            board.get_bitboard<virgo::WHITE>(virgo::QUEEN) | board.get_bitboard<virgo::BLACK>(virgo::QUEEN);
+        uint64_t orthogonal = board.get_bitboard<virgo::WHITE>(virgo::ROOK) | board.get_bitboard<virgo::BLACK>(virgo::ROOK) |
+                              board.get_bitboard<virgo::WHITE>(virgo::QUEEN) | board.get_bitboard<virgo::BLACK>(virgo::QUEEN);
+        virgo::Player side = board.color_on(from) == virgo::WHITE ? virgo::BLACK : virgo::WHITE;
+
+        // Nothing can recapture when the square isn't attacked and no slider of theirs
+        // lines up behind the moving piece
+        uint64_t their_sliders = (diagonal | orthogonal) &
+                                 (side == virgo::WHITE ? board.occupancy<virgo::WHITE>() : board.occupancy<virgo::BLACK>());
+        if (type != virgo::EN_PASSANT && !(attacks().by_player[side] & (1ull << to)) &&
+            !(LINE_MASK[from][to] & their_sliders)) {
+            return gain[0];
+        }
+
+        uint64_t attackers = attackers_to(to, occupied) & occupied;
+        int d = 0;
+
+        while (d < 31) {
+            uint64_t own = attackers & (side == virgo::WHITE ? board.occupancy<virgo::WHITE>() : board.occupancy<virgo::BLACK>());
+            if (!own) break;
+
+            virgo::Piece next = virgo::EMPTY;
+            uint64_t next_bb = 0;
+            for (virgo::Piece piece : order) {
+                uint64_t bb = own & (side == virgo::WHITE ? board.get_bitboard<virgo::WHITE>(piece) : board.get_bitboard<virgo::BLACK>(piece));
+                if (bb) {
+                    next = piece;
+                    next_bb = bb & (~bb + 1);
+                    break;
+                }
+            }
+
+            // The king can only take when nothing defends the square
+            if (next == virgo::KING && (attackers & ~own)) break;
+
+            // Stop once the side to capture loses material either way
+            if (std::max(-gain[d], values[attacker] - gain[d]) < 0) break;
+            d++;
+            gain[d] = values[attacker] - gain[d - 1];
+
+            occupied ^= next_bb;
+            attackers ^= next_bb;
+            if (next == virgo::PAWN || next == virgo::BISHOP || next == virgo::QUEEN) {
+                attackers |= moves::diagonal_attacks(occupied, to) & diagonal & occupied;
+            }
+            if (next == virgo::ROOK || next == virgo::QUEEN) {
+                attackers |= moves::orthogonal_attacks(occupied, to) & orthogonal & occupied;
+            }
+
+            attacker = next;
+            side = side == virgo::WHITE ? virgo::BLACK : virgo::WHITE;
+        }
+
+        while (d > 0) {
+            gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+            d--;
+        }
+        return gain[0];
     }
 
     bool is_game_over() {
@@ -217,7 +538,7 @@ struct Position {
 
     int get_piece_square_value(virgo::Piece piece, int square, bool endgame) {
         int actual_square = square;
-        if (board[square].second == virgo::BLACK) {
+        if (board.color_on(square) == virgo::BLACK) {
             actual_square = 63 - square;
         }
         
@@ -238,10 +559,10 @@ struct Position {
         int queen_count = 0;
         
         for (int square = 0; square < 64; square++) {
-            auto piece = board[square];
-            if (piece.first != virgo::EMPTY && piece.first != virgo::KING) {
+            virgo::Piece piece = board.piece_on(square);
+            if (piece != virgo::EMPTY && piece != virgo::KING) {
                 piece_count++;
-                if (piece.first == virgo::QUEEN) {
+                if (piece == virgo::QUEEN) {
                     queen_count++;
                 }
             }
@@ -250,50 +571,109 @@ struct Position {
         return piece_count <= 8 || queen_count == 0 || (queen_count <= 1 && piece_count <= 10);
     }
 
+    // Squares the pieces reach that are neither their own nor covered by enemy pawns
     int evaluate_mobility() {
-        int white_moves = 0;
-        int black_moves = 0;
+        const virgo::AttackInfo &info = attacks();
+        int score = 0;
 
-        auto current_next = board.get_next_to_move();
+        for (int color = virgo::BLACK; color <= virgo::WHITE; color++) {
+            uint64_t own = (color == virgo::WHITE) ? board.occupancy<virgo::WHITE>() : board.occupancy<virgo::BLACK>();
+            uint64_t safe = ~own & ~info.by_piece[color ^ 1][virgo::PAWN];
+            int moves = pop_count(info.by_piece[color][virgo::KNIGHT] & safe) +
+                        pop_count(info.by_piece[color][virgo::BISHOP] & safe) +
+                        pop_count(info.by_piece[color][virgo::ROOK] & safe) +
+                        pop_count(info.by_piece[color][virgo::QUEEN] & safe);
+            score += (color == virgo::WHITE) ? moves : -moves;
+        }
 
-        if (current_next == virgo::WHITE) {
-            white_moves = get_legal_moves().size();
+        return score;
+    }
 
-            std::vector<uint16_t> black_moves_list;
-            virgo::get_legal_moves<virgo::BLACK>(board, black_moves_list);
-            black_moves = black_moves_list.size();
-        } else {
-            black_moves = get_legal_moves().size();
+    // Enemy attacks on the squares around each king, weighted by attacker type.
+    // The penalty grows quadratically so several attackers count for more than
+    // the same attacks one at a time; pinned pieces add a flat penalty.
+    int evaluate_king_safety() {
+        // Indexed by virgo::Piece: PAWN, ROOK, KNIGHT, BISHOP, KING, QUEEN
+        static const int attack_weight[6] = {1, 3, 2, 2, 0, 5};
+        const virgo::AttackInfo &info = attacks();
+        int score = 0;
 
-            std::vector<uint16_t> white_moves_list;
-            virgo::get_legal_moves<virgo::WHITE>(board, white_moves_list);
-            white_moves = white_moves_list.size();
+        for (int color = virgo::BLACK; color <= virgo::WHITE; color++) {
+            int king = (color == virgo::WHITE) ? board.king_square<virgo::WHITE>() : board.king_square<virgo::BLACK>();
+            uint64_t zone = KING_ATTACKS[king] | (1ull << king);
+            int units = 0;
+            for (int piece = virgo::PAWN; piece <= virgo::QUEEN; piece++) {
+                units += attack_weight[piece] * pop_count(info.by_piece[color ^ 1][piece] & zone);
+            }
+            int penalty = std::min(units * units / 4, 400) + 15 * pop_count(info.pinned[color]);
+            score += (color == virgo::WHITE) ? -penalty : penalty;
         }
 
-        return (white_moves - black_moves);
+        return score;
     }
 
-    int evaluate_pawn_structure() {
+    // Doubled, isolated, backward, connected and passed pawns for one side
+    static int evaluate_pawns(virgo::Player side, uint64_t own, uint64_t enemy) {
+        static const int passed_bonus[8] = {0, 5, 10, 20, 35, 60, 100, 0};
+
         int score = 0;
-        
-        // Doubled pawns, isolated pawns, passed pawns
-        uint64_t white_pawns = board.get_bitboard<virgo::WHITE>(virgo::PAWN);
-        uint64_t black_pawns = board.get_bitboard<virgo::BLACK>(virgo::PAWN);
+        virgo::Player them = static_cast<virgo::Player>(side ^ 1);
+        uint64_t own_attacks = pawn_attacks_mask(side, own);
+        uint64_t enemy_attacks = pawn_attacks_mask(them, enemy);
 
         for (int file = 0; file < 8; file++) {
-            int white_pawns_in_file = 0;
-            int black_pawns_in_file = 0;
-            
-            for (int rank = 0; rank < 8; rank++) {
-                int square = rank * 8 + file;
-                if (white_pawns & (1ULL << square)) white_pawns_in_file++;
-                if (black_pawns & (1ULL << square)) black_pawns_in_file++;
+            int count = pop_count(own & file_mask(file));
+            if (count > 1) score -= 10 * (count - 1);
+        }
+
+        uint64_t pawns = own;
+        while (pawns) {
+            int square = lsb_index(pawns);
+            pawns &= pawns - 1;
+
+            int file = square & 7;
+            int relative_rank = (side == virgo::WHITE) ? (square >> 3) : 7 - (square >> 3);
+            uint64_t bit = 1ull << square;
+            uint64_t neighbours = own & adjacent_files_mask(file);
+            uint64_t ahead = forward_ranks_mask(side, square);
+
+            if (!(enemy & ahead & (file_mask(file) | adjacent_files_mask(file)))) {
+                score += passed_bonus[relative_rank];
             }
 
-            if (white_pawns_in_file > 1) score -= 10 * (white_pawns_in_file - 1);
-            if (black_pawns_in_file > 1) score += 10 * (black_pawns_in_file - 1);
+            if (!neighbours) {
+                score -= 15;
+            } else if (!(neighbours & ~ahead)) {
+                // no friendly pawn level or behind on the adjacent files can
+                // ever support it, and its stop square is controlled
+                int stop = (side == virgo::WHITE) ? square + 8 : square - 8;
+                if (enemy_attacks & (1ull << stop)) score -= 8;
+            }
+
+            bool phalanx = neighbours & (0xffull << (square & ~7));
+            if ((own_attacks & bit) || phalanx) {
+                score += 5 + relative_rank;
+            }
         }
-        
+
+        return score;
+    }
+
+    int evaluate_pawn_structure() {
+        uint64_t key = board.get_pawn_key();
+        auto &entry = pawn_table.probe(key);
+        if (entry.key == key && key != 0) {
+            return entry.score;
+        }
+
+        uint64_t white_pawns = board.get_bitboard<virgo::WHITE>(virgo::PAWN);
+        uint64_t black_pawns = board.get_bitboard<virgo::BLACK>(virgo::PAWN);
+
+        int score = evaluate_pawns(virgo::WHITE, white_pawns, black_pawns) -
+                    evaluate_pawns(virgo::BLACK, black_pawns, white_pawns);
+
+        entry.key = key;
+        entry.score = score;
         return score;
     }
 
@@ -323,43 +703,46 @@ struct Position {
     }
 
     bool is_in_check() {
-        virgo::Player current = board.get_next_to_move();
-
-        virgo::Chessboard temp_board = board;
+        return attacks().checkers != 0;
+    }
 
-        int king_square = (current == virgo::WHITE) ? 
-            temp_board.king_square<virgo::WHITE>() : 
-            temp_board.king_square<virgo::BLACK>();
+    // Whether the side to move has a piece other than pawns and the king;
+    // without one, zugzwang makes passing unsafe
+    bool has_non_pawn_material() {
+        virgo::Player us = board.get_next_to_move();
+        uint64_t pieces = (us == virgo::WHITE)
+            ? board.get_bitboard<virgo::WHITE>(virgo::KNIGHT) | board.get_bitboard<virgo::WHITE>(virgo::BISHOP) |
+              board.get_bitboard<virgo::WHITE>(virgo::ROOK) | board.get_bitboard<virgo::WHITE>(virgo::QUEEN)
+            : board.get_bitboard<virgo::BLACK>(virgo::KNIGHT) | board.get_bitboard<virgo::BLACK>(virgo::BISHOP) |
+              board.get_bitboard<virgo::BLACK>(virgo::ROOK) | board.get_bitboard<virgo::BLACK>(virgo::QUEEN);
+        return pieces != 0;
+    }
 
-        std::vector<uint16_t> opponent_moves;
-        if (current == virgo::WHITE) {
-            virgo::get_legal_moves<virgo::BLACK>(temp_board, opponent_moves);
-        } else {
-            virgo::get_legal_moves<virgo::WHITE>(temp_board, opponent_moves);
-        }
-        
-        for (auto move : opponent_moves) {
-            int to_square = (move >> 6) & 0x3F;
-            if (to_square == king_square) {
-                return true;
-            }
+    int evaluate() {
+        // the salt keeps classic and NNUE scores apart when switching evals
+        uint64_t key = board.get_key() ^ (nnue::enabled ? EvalCache::NNUE_SALT : 0);
+        int eval;
+        if (eval_cache.probe(key, eval)) {
+            return eval;
         }
-        
-        return false;
+
+        eval = nnue::enabled ? nnue::network.evaluate(board, accumulators) : evaluate_classic();
+        eval_cache.store(key, eval);
+        return eval;
     }
 
-    int evaluate() {
+    int evaluate_classic() {
         bool endgame = is_endgame();
         int score = 0;
 
         for (int square = 0; square < 64; square++) {
-            auto piece = board[square];
-            if (piece.first != virgo::EMPTY) {
-                int material_value = get_piece_value(piece.first);
-                int positional_value = get_piece_square_value(piece.first, square, endgame);
+            virgo::Piece piece = board.piece_on(square);
+            if (piece != virgo::EMPTY) {
+                int material_value = get_piece_value(piece);
+                int positional_value = get_piece_square_value(piece, square, endgame);
                 int total_value = material_value + positional_value;
                 
-                if (piece.second == virgo::WHITE) {
+                if (board.color_on(square) == virgo::WHITE) {
                     score += total_value;
                 } else {
                     score -= total_value;
@@ -370,6 +753,9 @@ struct Position {
         score += evaluate_mobility();
         score += evaluate_pawn_structure();
         score += evaluate_bishop_pair();
+        if (!endgame) {
+            score += evaluate_king_safety();
+        }
         
         // Tempo bonus (small bonus for side to move)
         if (board.get_next_to_move() == virgo::WHITE) {
@@ -384,6 +770,69 @@ struct Position {
     std::string move_to_uci(uint16_t move) {
         return virgo::string::move_to_string(move);
     }
+
+    int piece_count() {
+        uint64_t all = board.occupancy();
+        int count = 0;
+        while (all) {
+            count++;
+            all &= all - 1;
+        }
+        return count;
+    }
+
+    bool has_castling_rights() {
+        return board.can_castle_king_side<virgo::WHITE>() || board.can_castle_queen_side<virgo::WHITE>() ||
+               board.can_castle_king_side<virgo::BLACK>() || board.can_castle_queen_side<virgo::BLACK>();
+    }
+
+    std::string to_fen() {
+        static const char piece_chars[2][6] = {
+            {'p', 'r', 'n', 'b', 'k', 'q'},
+            {'P', 'R', 'N', 'B', 'K', 'Q'}
+        };
+
+        std::string fen;
+        for (int rank = 7; rank >= 0; rank--) {
+            int empty = 0;
+            for (int file = 0; file < 8; file++) {
+                int square = rank * 8 + file;
+                virgo::Piece piece = board.piece_on(square);
+                if (piece == virgo::EMPTY) {
+                    empty++;
+                    continue;
+                }
+                if (empty) {
+                    fen.push_back('0' + empty);
+                    empty = 0;
+                }
+                fen.push_back(piece_chars[board.color_on(square)][piece]);
+            }
+            if (empty) fen.push_back('0' + empty);
+            if (rank > 0) fen.push_back('/');
+        }
+
+        fen += (board.get_next_to_move() == virgo::WHITE) ? " w " : " b ";
+
+        std::string castling;
+        if (board.can_castle_king_side<virgo::WHITE>()) castling.push_back('K');
+        if (board.can_castle_queen_side<virgo::WHITE>()) castling.push_back('Q');
+        if (board.can_castle_king_side<virgo::BLACK>()) castling.push_back('k');
+        if (board.can_castle_queen_side<virgo::BLACK>()) castling.push_back('q');
+        fen += castling.empty() ? "-" : castling;
+
+        unsigned int ep = board.get_enpassant();
+        if (ep != virgo::INVALID) {
+            fen.push_back(' ');
+            fen.push_back('a' + (ep & 7));
+            fen.push_back('1' + (ep >> 3));
+        } else {
+            fen += " -";
+        }
+
+        fen += " " + std::to_string(board.get_fifty_mv_counter()) + " 1";
+        return fen;
+    }
 };
 
 }  // namespace board_adapter
\ No newline at end of file
@@ -0,0 +1,92 @@
+// coalesce.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace coalesce {
+
+// Lets identical requests share one search. The first caller for a key
+// becomes the leader and searches; callers arriving while it runs wait for
+// its result instead of searching the same thing again. The leader publishes
+// every completed iteration, so a waiter whose deadline comes first leaves
+// with the best result so far.
+template <typename Result> class Coalescer {
+public:
+    struct Flight {
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool done = false;
+        bool has_progress = false;
+        Result result;
+    };
+
+    // The search in flight for key, or a new one if there is none; leader
+    // tells whether the caller must run it
+    std::shared_ptr<Flight> join(uint64_t key, bool &leader) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = flights.find(key);
+        if (it != flights.end()) {
+            leader = false;
+            joined++;
+            return it->second;
+        }
+        leader = true;
+        auto flight = std::make_shared<Flight>();
+        flights[key] = flight;
+        return flight;
+    }
+
+    // Result of an iteration that completed, for waiters out of time
+    void progress(Flight &flight, const Result &result) {
+        std::lock_guard<std::mutex> lock(flight.mutex);
+        flight.result = result;
+        flight.has_progress = true;
+        flight.changed.notify_all();
+    }
+
+    // The final result; later callers for key start a new search
+    void finish(uint64_t key, Flight &flight, const Result &result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flights.erase(key);
+        }
+        std::lock_guard<std::mutex> lock(flight.mutex);
+        flight.result = result;
+        flight.done = true;
+        flight.changed.notify_all();
+    }
+
+    // The final result if it arrives by deadline, else the latest progress.
+    // With nothing published yet it keeps waiting: the first iteration
+    // always completes and takes a few milliseconds.
+    template <typename Clock, typename Duration>
+    Result wait(Flight &flight, std::chrono::time_point<Clock, Duration> deadline) {
+        std::unique_lock<std::mutex> lock(flight.mutex);
+        flight.changed.wait_until(lock, deadline, [&] { return flight.done; });
+        flight.changed.wait(lock, [&] { return flight.done || flight.has_progress; });
+        if (!flight.done) early++;
+        return flight.result;
+    }
+
+    Result wait(Flight &flight) {
+        std::unique_lock<std::mutex> lock(flight.mutex);
+        flight.changed.wait(lock, [&] { return flight.done; });
+        return flight.result;
+    }
+
+    // Callers that waited on another's search, and those of them that left
+    // before it finished
+    std::atomic<uint64_t> joined{0};
+    std::atomic<uint64_t> early{0};
+
+private:
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<Flight>> flights;
+};
+
+}  // namespace coalesce
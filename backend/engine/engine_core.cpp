@@ -3,35 +3,183 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include "board_adapter.h"
+#include "polyglot_book.h"
+#include "tablebase.h"
+#include "move_ordering.h"
+#include "search_stack.h"
+#include "mate_solver.h"
+#include "transposition_table.h"
+#include "tt_snapshot.h"
+#include "result_cache.h"
+#include "coalesce.h"
+#include "scheduler.h"
+#include "search_policies.h"
 #include <chrono>
+#include <cmath>
 #include <unordered_map>
 #include <string>
 #include <algorithm>
 #include <iostream>
+#include <random>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
 
 namespace py = pybind11;
 using namespace board_adapter;
+using move_ordering::tables;
+using search::SearchStack;
 
-static bool virgo_initialized = false;
+// searches on several threads may be the first
+static std::once_flag virgo_initialized;
+
+// late move reductions by depth and move number, growing with the log of both
+static int lmr_table[64][64];
+
+void init_reductions() {
+    for (int depth = 1; depth < 64; depth++) {
+        for (int move_number = 1; move_number < 64; move_number++) {
+            lmr_table[depth][move_number] = static_cast<int>(0.75 + std::log(depth) * std::log(move_number) / 2.25);
+        }
+    }
+}
+
+// Margins and depth limits of the pruning near the leaves, tunable from Python
+struct SearchOptions {
+    int rfp_depth = 6;          // reverse futility up to this depth
+    int rfp_margin = 80;        // per ply of depth
+    int razor_depth = 2;
+    int razor_margin = 300;     // per ply of depth
+    int futility_depth = 3;     // quiet moves pruned up to this depth
+    int futility_margin = 120;  // per ply of depth
+    int lmp_depth = 4;          // late move pruning up to this depth
+    int lmp_base = 3;           // quiet moves searched: lmp_base + depth * depth
+};
+
+static SearchOptions search_options;
+
+// late move pruning limits by depth, rebuilt when the options change
+static int lmp_table[64];
+
+void init_lmp_table() {
+    for (int depth = 0; depth < 64; depth++) {
+        lmp_table[depth] = search_options.lmp_base + depth * depth;
+    }
+}
+
+// transposition table, private to the process unless attached to a shared segment
+using TTEntry = tt::Entry;
+static tt::Table transposition_table;
+
+// entries saved by an earlier process, probed when the live table misses
+static tt::Snapshot tt_snapshot;
+
+bool probe_tt(uint64_t key, TTEntry &entry) {
+    return transposition_table.probe(key, entry) || tt_snapshot.probe(key, entry);
+}
+
+// The table every worker process can share, backed by the snapshot
+struct SharedTable {
+    static bool probe(uint64_t key, TTEntry &entry) { return probe_tt(key, entry); }
+    static void store(uint64_t key, const TTEntry &entry) { transposition_table.store(key, entry); }
+    static void new_search() { transposition_table.new_search(); }
+};
 
 void initialize_virgo() {
-    if (!virgo_initialized) {
+    std::call_once(virgo_initialized, [] {
         virgo::virgo_init();
-        virgo_initialized = true;
+        cuckoo.init();
+        init_reductions();
+        init_lmp_table();
+        if (!transposition_table.is_allocated()) {
+            transposition_table.resize(tt::Table::DEFAULT_MB);
+        }
         //std::cout << "Virgo initialized" << std::endl;
+    });
+}
+
+// Mate scores count plies from the root, MATE_SCORE - ply for the side
+// giving mate, so nearer mates score higher. Beyond MATE_IN_MAX_PLY is a mate.
+const int MATE_SCORE = 100000;
+const int MATE_IN_MAX_PLY = MATE_SCORE - search::MAX_PLY;
+
+// Tablebase wins count down with the ply like mates do
+const int TB_WIN_IN_MAX_PLY = tablebase::TB_WIN_SCORE - search::MAX_PLY;
+
+// The TT keeps mate and tablebase scores relative to the node instead of the
+// root, so an entry stays right when the position is reached at another ply
+int score_to_tt(int score, int ply) {
+    if (score >= TB_WIN_IN_MAX_PLY) return score + ply;
+    if (score <= -TB_WIN_IN_MAX_PLY) return score - ply;
+    return score;
+}
+
+int score_from_tt(int score, int ply) {
+    if (score >= TB_WIN_IN_MAX_PLY) return score - ply;
+    if (score <= -TB_WIN_IN_MAX_PLY) return score + ply;
+    return score;
+}
+
+// Moves to mate for a score, negative when getting mated, 0 if not a mate
+int mate_in(int score) {
+    if (score >= MATE_IN_MAX_PLY) return (MATE_SCORE - score + 1) / 2;
+    if (score <= -MATE_IN_MAX_PLY) return -(MATE_SCORE + score) / 2;
+    return 0;
+}
+
+// opening book, shared read-only through the page cache
+static polyglot::Book opening_book;
+static thread_local std::mt19937_64 book_rng(std::random_device{}());
+
+// syzygy endgame tablebases
+static tablebase::Tablebase tablebases;
+
+// finished searches shared across requests
+static result_cache::Cache search_results;
+
+// Searches run in parallel, each holding search_mutex shared; the tables,
+// book and options they read only change under the exclusive lock
+static std::shared_mutex search_mutex;
+
+std::unique_lock<std::shared_mutex> pause_search() {
+    py::gil_scoped_release release;
+    return std::unique_lock<std::shared_mutex>(search_mutex);
+}
+
+// For readers like the book probes, which run alongside the searches
+std::shared_lock<std::shared_mutex> share_search() {
+    py::gil_scoped_release release;
+    return std::shared_lock<std::shared_mutex>(search_mutex);
+}
+
+// nodes visited by this thread's search, negamax and quiescence together
+static thread_local uint64_t node_count = 0;
+
+// node budget of the current search, 0 for none, and the time it must stop
+// by when time_limited, which holds even with a node budget; once either is
+// spent the search unwinds and the last completed iteration is used
+static thread_local uint64_t node_limit = 0;
+static thread_local bool time_limited = false;
+static thread_local std::chrono::steady_clock::time_point stop_time;
+static thread_local bool stop_search = false;
+
+bool out_of_budget() {
+    if (node_limit && node_count >= node_limit) {
+        stop_search = true;
+    } else if (time_limited && (node_count & 1023) == 0 && std::chrono::steady_clock::now() >= stop_time) {
+        stop_search = true;
     }
+    return stop_search;
 }
 
-// transposition table
-struct TTEntry {
-    int depth;
-    int eval;
-    uint16_t best_move;
-    int node_type; // 0=exact, 1=upper bound, 2=lower bound
+// A root move with its score and the size of its subtree in the last iteration
+struct RootMove {
+    uint16_t move;
+    int score;
+    uint64_t nodes;
+    std::vector<uint16_t> pv;
 };
 
-static std::unordered_map<uint64_t, TTEntry> transposition_table;
-
 uint64_t simple_hash(Position &pos) {
     return pos.hash_position();
 }
@@ -41,58 +189,129 @@ bool is_promotion(uint16_t move) {
     return (move_type >= virgo::PQ_R && move_type <= virgo::PC_N);
 }
 
-int quiescence(Position &pos, int alpha, int beta) {
-    int stand_pat = pos.evaluate();
-    
-    if (stand_pat >= beta) return beta;
-    if (alpha < stand_pat) alpha = stand_pat;
-    
+// Captures that cannot lift the score to alpha even with this much to spare are skipped
+const int DELTA_MARGIN = 200;
+
+template <typename V>
+int quiescence(Position &pos, int alpha, int beta, int ply) {
+    node_count++;
+    if (out_of_budget()) return 0;
+
+    // Any stored entry is deep enough here; depth 0 entries come from quiescence itself
+    uint64_t key = simple_hash(pos);
+    uint16_t tt_move = 0;
+    bool main_search_entry = false;
+    TTEntry tt_entry;
+    if (V::Table::probe(key, tt_entry)) {
+        main_search_entry = tt_entry.depth > 0;
+        int tt_eval = score_from_tt(tt_entry.eval, ply);
+        if (tt_entry.node_type == 0 ||
+            (tt_entry.node_type == 1 && tt_eval <= alpha) ||
+            (tt_entry.node_type == 2 && tt_eval >= beta)) {
+            return tt_eval;
+        }
+        tt_move = tt_entry.best_move;
+    }
+
+    bool in_check = pos.is_in_check();
     auto moves = pos.get_legal_moves();
-    // Only consider captures in quiescence
-    std::vector<uint16_t> capture_moves;
+    int original_alpha = alpha;
+    int stand_pat = 0;
+
+    if (in_check) {
+        // No standing pat in check: every evasion is searched
+        if (moves.empty()) return -MATE_SCORE + ply;
+    } else {
+        stand_pat = V::Eval::evaluate(pos);
+        if (stand_pat >= beta) return beta;
+        if (alpha < stand_pat) alpha = stand_pat;
+    }
+    
+    // Out of check only captures are considered, skipping those that lose material
+    std::vector<std::pair<int, uint16_t>> capture_moves;
     for (auto move : moves) {
         int to_square = MOVE_TO(move);
-        auto piece = pos.board[to_square];
-        if (piece.first != virgo::EMPTY) {
-            capture_moves.push_back(move);
+        virgo::Piece piece = pos.board.piece_on(to_square);
+        if (move == tt_move && (in_check || piece != virgo::EMPTY)) {
+            capture_moves.push_back({100000, move});
+        } else if (piece != virgo::EMPTY) {
+            int see_score = pos.see(move);
+            if (see_score >= 0 || in_check) {
+                capture_moves.push_back({see_score, move});
+            }
+        } else if (in_check) {
+            capture_moves.push_back({-100000, move});
         }
     }
     
-    std::sort(capture_moves.begin(), capture_moves.end(), [&](uint16_t a, uint16_t b) {
-        int toA = MOVE_TO(a);
-        int toB = MOVE_TO(b);
-        auto victimA = pos.board[toA];
-        auto victimB = pos.board[toB];
-        int fromA = MOVE_FROM(a);
-        int fromB = MOVE_FROM(b);
-        auto attackerA = pos.board[fromA];
-        auto attackerB = pos.board[fromB];
-        
-        const int piece_values[] = {0, 100, 500, 320, 330, 10000, 900};
-        int scoreA = piece_values[victimA.first] - piece_values[attackerA.first]/10;
-        int scoreB = piece_values[victimB.first] - piece_values[attackerB.first]/10;
-        return scoreA > scoreB;
-    });
+    std::sort(capture_moves.begin(), capture_moves.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
     
-    for (auto move : capture_moves) {
+    uint16_t best_move = 0;
+    for (const auto& [see_score, move] : capture_moves) {
+        // Delta pruning: even winning the piece outright would not reach alpha
+        virgo::Piece victim = pos.board.piece_on(MOVE_TO(move));
+        if (V::Pruning::DELTA && !in_check && !is_promotion(move) && victim != virgo::EMPTY &&
+            stand_pat + Position::get_piece_value(victim) + DELTA_MARGIN <= alpha) {
+            continue;
+        }
+
         pos.make_move(move);
-        int score = -quiescence(pos, -beta, -alpha);
+        int score = -quiescence<V>(pos, -beta, -alpha, ply + 1);
         pos.undo_move();
         
-        if (score >= beta) return beta;
-        if (score > alpha) alpha = score;
+        if (score >= beta) {
+            alpha = beta;
+            best_move = move;
+            break;
+        }
+        if (score > alpha) {
+            alpha = score;
+            best_move = move;
+        }
+    }
+
+    // Store as depth 0 without overwriting entries from the main search
+    if (!main_search_entry && !stop_search) {
+        TTEntry entry;
+        entry.depth = 0;
+        entry.eval = score_to_tt(alpha, ply);
+        entry.best_move = best_move;
+        entry.node_type = (alpha <= original_alpha) ? 1 : (alpha >= beta) ? 2 : 0;
+        V::Table::store(key, entry);
     }
     
     return alpha;
 }
 
-std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta, bool nullWindow = false) {
+// The new principal variation starts with move and continues with the child's
+void update_pv(SearchStack *ss, uint16_t move) {
+    ss->pv[0] = move;
+    std::copy((ss + 1)->pv, (ss + 1)->pv + (ss + 1)->pv_length, ss->pv + 1);
+    ss->pv_length = (ss + 1)->pv_length + 1;
+}
+
+// Searches the node at ss->ply and returns its score; its principal
+// variation is left in ss->pv
+template <typename V>
+int negamax(Position &pos, SearchStack *ss, int depth, int alpha, int beta, bool nullWindow = false, bool allowNull = true) {
+    node_count++;
+    ss->pv_length = 0;
+    if (out_of_budget()) return 0;
+
     if (pos.is_repetition_draw(2)) {
-        return {0, 0};
+        return 0;
+    }
+
+    // Mate distance pruning: nothing here can beat a mate found nearer the root
+    alpha = std::max(alpha, -MATE_SCORE + ss->ply);
+    beta = std::min(beta, MATE_SCORE - ss->ply - 1);
+    if (alpha >= beta) {
+        return alpha;
     }
 
-    if (depth == 0) {
-        return {quiescence(pos, alpha, beta), 0};
+    if (depth == 0 || ss->ply >= search::MAX_PLY - 1) {
+        return quiescence<V>(pos, alpha, beta, ss->ply);
     }
     
     auto moves = pos.get_legal_moves();
@@ -100,31 +319,101 @@ std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta,
         bool in_check = pos.is_in_check();
         if (in_check) {
             // Checkmate
-            return {-100000 + depth, 0};
+            return -MATE_SCORE + ss->ply;
         } else {
             // Stalemate
-            return {0, 0};
+            return 0;
         }
     }
     
+    // TT cutoffs only off the principal variation: a PV node returning early
+    // would leave its line cut short
     uint64_t key = simple_hash(pos);
-    auto tt_it = transposition_table.find(key);
-    if (tt_it != transposition_table.end() && tt_it->second.depth >= depth) {
-        if (tt_it->second.node_type == 0) {
-            return {tt_it->second.eval, tt_it->second.best_move};
-        } else if (tt_it->second.node_type == 1) { 
-            if (tt_it->second.eval <= alpha) return {tt_it->second.eval, tt_it->second.best_move};
-            beta = std::min(beta, tt_it->second.eval);
-        } else if (tt_it->second.node_type == 2) {
-            if (tt_it->second.eval >= beta) return {tt_it->second.eval, tt_it->second.best_move};
-            alpha = std::max(alpha, tt_it->second.eval);
+    TTEntry tt_entry;
+    bool tt_hit = V::Table::probe(key, tt_entry);
+    if (nullWindow && tt_hit && tt_entry.depth >= depth) {
+        int tt_eval = score_from_tt(tt_entry.eval, ss->ply);
+        if (tt_entry.node_type == 0) {
+            return tt_eval;
+        } else if (tt_entry.node_type == 1) { 
+            if (tt_eval <= alpha) return tt_eval;
+            beta = std::min(beta, tt_eval);
+        } else if (tt_entry.node_type == 2) {
+            if (tt_eval >= beta) return tt_eval;
+            alpha = std::max(alpha, tt_eval);
+        }
+    }
+
+    // Tablebase results once a capture or pawn move enters their range, as
+    // far as the request probed them ahead of the search
+    if (pos.board.get_fifty_mv_counter() == 0 && tablebases.in_range(pos)) {
+        int wdl;
+        if (tablebases.cached_wdl(pos, wdl)) {
+            int tb_score = tablebase::Tablebase::wdl_to_score(wdl, ss->ply);
+            TTEntry entry;
+            entry.depth = 100;
+            entry.eval = score_to_tt(tb_score, ss->ply);
+            entry.best_move = 0;
+            entry.node_type = 0;
+            V::Table::store(key, entry);
+            return tb_score;
         }
     }
 
     std::vector<std::pair<int, uint16_t>> move_scores;
     uint16_t tt_move = 0;
-    if (tt_it != transposition_table.end()) {
-        tt_move = tt_it->second.best_move;
+    if (tt_hit) {
+        tt_move = tt_entry.best_move;
+    }
+
+    // Static eval of this node, used to penalise repetitions when winning
+    int current_eval = V::Eval::evaluate(pos);
+    int repeat_from = -1, repeat_to = -1;
+    bool repetition_ahead = abs(current_eval) > 100 && pos.upcoming_repetition(repeat_from, repeat_to);
+    bool in_check = pos.is_in_check();
+    virgo::Player us = pos.get_next_to_move();
+    uint16_t counter_move = V::Ordering::counter_move(ss);
+
+    // Improving: the static eval is better than on our previous move, so
+    // pruning can be bolder when it is not
+    ss->static_eval = in_check ? search::NO_EVAL : current_eval;
+    bool improving = !in_check && (ss - 2)->static_eval != search::NO_EVAL && ss->static_eval > (ss - 2)->static_eval;
+
+    // Reverse futility: far enough above beta, a shallow node is not expected to drop below it
+    if (V::Pruning::REVERSE_FUTILITY && nullWindow && !in_check && depth <= search_options.rfp_depth && abs(beta) < 9000 &&
+        current_eval - search_options.rfp_margin * (depth - improving) >= beta) {
+        return current_eval;
+    }
+
+    // Razoring: far below alpha, only captures could save the node, so ask quiescence
+    if (V::Pruning::RAZORING && nullWindow && !in_check && depth <= search_options.razor_depth &&
+        current_eval + search_options.razor_margin * depth <= alpha) {
+        int q_eval = quiescence<V>(pos, alpha, alpha + 1, ss->ply);
+        if (q_eval <= alpha) {
+            return q_eval;
+        }
+    }
+
+    // Quiet moves that cannot lift the static eval to alpha are skipped near the leaves
+    bool futile = V::Pruning::FUTILITY && nullWindow && !in_check && depth <= search_options.futility_depth && abs(alpha) < 9000 &&
+                  current_eval + search_options.futility_margin * depth <= alpha;
+    bool late_move_pruning = V::Pruning::LATE_MOVE_PRUNING && nullWindow && !in_check && depth <= search_options.lmp_depth;
+
+    // Null move: if passing still fails high, some real move will too. Never
+    // twice in a row, and only with pieces left, as zugzwang breaks the idea.
+    if (V::Pruning::NULL_MOVE && nullWindow && allowNull && !in_check && depth >= 3 && current_eval >= beta &&
+        abs(beta) < 9000 && pos.has_non_pawn_material()) {
+        int R = 2 + depth / 4;
+        ss->current_move = 0;
+        ss->moved_piece = move_ordering::NO_PIECE;
+        pos.make_null_move();
+        int null_eval = -negamax<V>(pos, ss + 1, std::max(depth - 1 - R, 0), -beta, -beta + 1, true, false);
+        pos.undo_null_move();
+
+        if (null_eval >= beta) {
+            // unproven mates from a null move search are not trusted
+            return null_eval >= 9000 ? beta : null_eval;
+        }
     }
     
     for (auto move : moves) {
@@ -136,25 +425,31 @@ std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta,
         
         int to_square = MOVE_TO(move);
         int from_square = MOVE_FROM(move);
-        auto captured_piece = pos.board[to_square];
+        virgo::Piece captured_piece = pos.board.piece_on(to_square);
         
-        if (captured_piece.first != virgo::EMPTY) {
-            const int piece_values[] = {0, 100, 500, 320, 330, 10000, 900};
-            score += piece_values[captured_piece.first] * 10;
-            auto attacker = pos.board[from_square];
-            if (piece_values[attacker.first] < piece_values[captured_piece.first]) {
-                score += 50;
+        if (captured_piece != virgo::EMPTY) {
+            // Winning and even captures by MVV/LVA, losing ones after the quiet moves
+            int see_score = pos.see(move);
+            if (see_score >= 0) {
+                virgo::Piece attacker = pos.board.piece_on(from_square);
+                score += 1000 + Position::get_piece_value(captured_piece) * 10 -
+                         Position::get_piece_value(attacker) / 10;
+            } else {
+                score += move_ordering::LOSING_CAPTURE + see_score;
             }
         }
 
         if (is_promotion(move)) {
             score += 800;
+        } else if (captured_piece == virgo::EMPTY && MOVE_TYPE(move) != virgo::EN_PASSANT) {
+            int piece = move_ordering::piece_index(us, pos.board.piece_on(from_square));
+            score += V::Ordering::quiet_score(ss, counter_move, us, piece, move);
         }
         
         // Penalty for moves that cause repetition in winning positions
-        int current_eval = pos.evaluate();
-        if (abs(current_eval) > 100) { 
-            if (pos.would_cause_repetition(move, 2)) {
+        if (repetition_ahead) {
+            if ((from_square == repeat_from && to_square == repeat_to) ||
+                (from_square == repeat_to && to_square == repeat_from)) {
                 score -= 200;
             }
         }
@@ -169,20 +464,53 @@ std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta,
     uint16_t best_move = move_scores.empty() ? 0 : move_scores[0].second;
     int original_alpha = alpha;
     
+    int move_number = 0;
+
+    // Quiet moves searched so far, penalised if a later quiet move cuts off
+    uint16_t quiets_tried[64];
+    int quiet_pieces[64];
+    int quiet_count = 0;
+    
+    int late_move_limit = lmp_table[std::min(depth, 63)] / (improving ? 1 : 2);
+
     for (const auto& [score, move] : move_scores) {
+        bool quiet = pos.board.piece_on(MOVE_TO(move)) == virgo::EMPTY &&
+                     MOVE_TYPE(move) != virgo::EN_PASSANT && !is_promotion(move);
+        int piece = move_ordering::piece_index(us, pos.board.piece_on(MOVE_FROM(move)));
+        ss->current_move = move;
+        ss->moved_piece = piece;
         pos.make_move(move);
+        move_number++;
+
+        // Pruning never drops the first move, captures, promotions or checks
+        if (quiet && best_eval > -9000 && (futile || (late_move_pruning && move_number > late_move_limit)) &&
+            !pos.is_in_check()) {
+            pos.undo_move();
+            continue;
+        }
         
         int eval;
         if (best_eval == -1000000) {
-            auto [move_eval, _] = negamax(pos, depth - 1, -beta, -alpha);
-            eval = -move_eval;
+            eval = -negamax<V>(pos, ss + 1, depth - 1, -beta, -alpha, nullWindow);
         } else {
-            auto [move_eval, _] = negamax(pos, depth - 1, -alpha - 1, -alpha, true);
-            eval = -move_eval;
+            // Late quiet moves are searched shallower first and only get the
+            // full depth back if they beat alpha
+            int reduction = 0;
+            if (V::Pruning::LATE_MOVE_REDUCTIONS && depth >= 3 && move_number > 3 && quiet && !in_check && !pos.is_in_check()) {
+                reduction = lmr_table[std::min(depth, 63)][std::min(move_number, 63)];
+                if (!nullWindow) reduction--;
+                if (!improving) reduction++;
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
+
+            eval = -negamax<V>(pos, ss + 1, depth - 1 - reduction, -alpha - 1, -alpha, true);
+
+            if (reduction > 0 && eval > alpha) {
+                eval = -negamax<V>(pos, ss + 1, depth - 1, -alpha - 1, -alpha, true);
+            }
 
             if (eval > alpha && eval < beta) {
-                auto [re_eval, __] = negamax(pos, depth - 1, -beta, -alpha);
-                eval = -re_eval;
+                eval = -negamax<V>(pos, ss + 1, depth - 1, -beta, -alpha);
             }
         }
         pos.undo_move();
@@ -190,19 +518,31 @@ std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta,
         if (eval > best_eval) {
             best_eval = eval;
             best_move = move;
+            if (eval > alpha) {
+                update_pv(ss, move);
+            }
             alpha = std::max(alpha, eval);
         }
         
         if (alpha >= beta) {
+            if (quiet) {
+                V::Ordering::update_quiet(ss, depth, us, piece, move, quiets_tried, quiet_pieces, quiet_count);
+            }
             break;
         }
 
         alpha = std::max(alpha, eval);
+
+        if (quiet && quiet_count < 64) {
+            quiets_tried[quiet_count] = move;
+            quiet_pieces[quiet_count] = piece;
+            quiet_count++;
+        }
     }
 
     TTEntry entry;
     entry.depth = depth;
-    entry.eval = best_eval;
+    entry.eval = score_to_tt(best_eval, ss->ply);
     entry.best_move = best_move;
     
     if (best_eval <= original_alpha) {
@@ -212,12 +552,367 @@ std::pair<int, uint16_t> negamax(Position &pos, int depth, int alpha, int beta,
     } else {
         entry.node_type = 0;
     }
-    transposition_table[key] = entry;
+    if (!stop_search) {
+        V::Table::store(key, entry);
+    }
     
-    return {best_eval, best_move};
+    return best_eval;
 }
 
-py::dict get_best_move_cpp(const std::string &fen, int time_ms) {
+// Searches the root moves from index first on with PVS; the moves before it
+// are already settled MultiPV lines. The best move is moved to the front of
+// the range and the others are sorted by how many nodes their subtrees took,
+// a good predictor of which moves are hard to refute. Fail-soft, so
+// aspiration failures know how far outside the window the score fell.
+template <typename V>
+int search_root(Position &pos, std::vector<RootMove> &root_moves, size_t first, int depth, int alpha, int beta) {
+    int best_eval = -1000000;
+    int original_alpha = alpha;
+    virgo::Player us = pos.get_next_to_move();
+
+    SearchStack *ss = search::search_stack.root();
+    ss->static_eval = pos.is_in_check() ? search::NO_EVAL : V::Eval::evaluate(pos);
+
+    size_t best_index = first;
+    for (size_t i = first; i < root_moves.size(); i++) {
+        RootMove &root_move = root_moves[i];
+        uint64_t nodes_before = node_count;
+
+        ss->current_move = root_move.move;
+        ss->moved_piece = move_ordering::piece_index(us, pos.board.piece_on(MOVE_FROM(root_move.move)));
+        pos.make_move(root_move.move);
+
+        int eval;
+        if (i == first) {
+            eval = -negamax<V>(pos, ss + 1, depth - 1, -beta, -alpha);
+        } else {
+            eval = -negamax<V>(pos, ss + 1, depth - 1, -alpha - 1, -alpha, true);
+
+            if (eval > alpha && eval < beta) {
+                eval = -negamax<V>(pos, ss + 1, depth - 1, -beta, -alpha);
+            }
+        }
+        pos.undo_move();
+
+        root_move.score = eval;
+        root_move.nodes = node_count - nodes_before;
+
+        if (i == first || eval > alpha) {
+            root_move.pv.assign(1, root_move.move);
+            root_move.pv.insert(root_move.pv.end(), (ss + 1)->pv, (ss + 1)->pv + (ss + 1)->pv_length);
+        }
+
+        if (eval > best_eval) {
+            best_eval = eval;
+            best_index = i;
+        }
+
+        alpha = std::max(alpha, eval);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    // On a fail low no move is known to be better, keep the previous order first
+    if (best_eval > original_alpha) {
+        std::rotate(root_moves.begin() + first, root_moves.begin() + best_index, root_moves.begin() + best_index + 1);
+    }
+    std::stable_sort(root_moves.begin() + first + 1, root_moves.end(),
+                     [](const RootMove &a, const RootMove &b) { return a.nodes > b.nodes; });
+
+    // Later MultiPV lines leave moves out, their result is not the position's
+    if (first == 0 && !stop_search) {
+        TTEntry entry;
+        entry.depth = depth;
+        entry.eval = best_eval;
+        entry.best_move = root_moves[0].move;
+        entry.node_type = (best_eval <= original_alpha) ? 1 : (best_eval >= beta) ? 2 : 0;
+        V::Table::store(simple_hash(pos), entry);
+    }
+
+    return best_eval;
+}
+
+bool load_book(const std::string &path, const std::vector<uint64_t> &random64) {
+    initialize_virgo();
+    auto lock = pause_search();
+    opening_book.set_random_table(random64);
+    return opening_book.has_random_table() && opening_book.open(path);
+}
+
+void unload_book() {
+    auto lock = pause_search();
+    opening_book.close();
+}
+
+py::list book_moves(const std::string &fen) {
+    initialize_virgo();
+    auto lock = share_search();
+
+    Position pos(fen);
+    py::list result;
+    for (const auto &entry : opening_book.probe(pos.board, pos.get_legal_moves())) {
+        py::dict item;
+        item["move"] = pos.move_to_uci(entry.move);
+        item["weight"] = entry.weight;
+        result.append(item);
+    }
+    return result;
+}
+
+std::string book_move(const std::string &fen, bool weighted) {
+    initialize_virgo();
+    auto lock = share_search();
+
+    Position pos(fen);
+    uint16_t move = opening_book.pick(pos.board, pos.get_legal_moves(), weighted, book_rng);
+    return move ? pos.move_to_uci(move) : "";
+}
+
+// Probes go through python-chess with the GIL held, tens of microseconds
+// each, so requests make them before searching rather than the search
+// workers: the root move, and the positions up to probe_depth captures or
+// pawn moves ahead, up to a few hundred probes near the tables' range
+bool load_tablebases(const std::string &path, int max_pieces, int probe_depth) {
+    initialize_virgo();
+    auto lock = pause_search();
+    return tablebases.open(path, max_pieces, probe_depth);
+}
+
+void set_tablebase_pieces(int max_pieces) {
+    auto lock = pause_search();
+    tablebases.set_max_pieces(max_pieces);
+}
+
+// Cached results were scored by the old evaluation and search settings, so
+// changing them forgets those
+bool load_nnue(const std::string &path) {
+    auto lock = pause_search();
+    search_results.clear();
+    return nnue::load(path);
+}
+
+void set_nnue(bool enabled) {
+    auto lock = pause_search();
+    search_results.clear();
+    nnue::set_enabled(enabled);
+}
+
+// Static evaluation from the side to move's point of view, cached like the
+// search's
+int evaluate_position(const std::string &fen) {
+    initialize_virgo();
+    auto lock = share_search();
+    Position pos(fen);
+    return pos.evaluate();
+}
+
+// Leaves of the legal move tree depth plies deep, to check move generation
+// and make/undo against known counts
+uint64_t perft(Position &pos, int depth) {
+    auto moves = pos.get_legal_moves();
+    if (depth <= 1) return depth == 1 ? moves.size() : 1;
+    uint64_t leaves = 0;
+    for (auto move : moves) {
+        pos.make_move(move);
+        leaves += perft(pos, depth - 1);
+        pos.undo_move();
+    }
+    return leaves;
+}
+
+uint64_t perft_position(const std::string &fen, int depth) {
+    initialize_virgo();
+    py::gil_scoped_release release;
+    Position pos(fen);
+    return perft(pos, depth);
+}
+
+// Private transposition table of about mb megabytes, replacing a shared one
+bool set_hash_size(size_t mb) {
+    auto lock = pause_search();
+    bool own_resized = policy::OwnTables::instance().resize(mb);
+    return transposition_table.resize(mb) && own_resized;
+}
+
+// Back the transposition table with the shared-memory segment called name, so
+// every worker process attaching to it searches with the same table. Falls
+// back to a private table when the segment cannot be used.
+bool attach_shared_hash(const std::string &name, size_t mb) {
+    auto lock = pause_search();
+    if (transposition_table.attach_shared(name, mb)) {
+        return true;
+    }
+    transposition_table.resize(mb);
+    return false;
+}
+
+void clear_hash() {
+    auto lock = pause_search();
+    transposition_table.clear();
+    policy::OwnTables::instance().clear();
+    search_results.clear();
+}
+
+py::dict hash_info() {
+    py::dict result;
+    result["entries"] = transposition_table.entries();
+    result["mb"] = transposition_table.size_mb();
+    result["shared"] = transposition_table.is_shared();
+    result["snapshot_entries"] = tt_snapshot.entries();
+    return result;
+}
+
+// Save the entries searched to at least min_depth, together with those of the
+// loaded snapshot, for the next process to start from. Returns the number of
+// entries written, -1 on error.
+long long save_hash_snapshot(const std::string &path, int min_depth) {
+    auto lock = pause_search();
+    return tt_snapshot.save(path, transposition_table, min_depth);
+}
+
+// Map a snapshot written by save_hash_snapshot; its pages load on demand
+bool load_hash_snapshot(const std::string &path) {
+    auto lock = pause_search();
+    return tt_snapshot.load(path);
+}
+
+// Bound the result cache to about entries positions, 0 to turn it off
+void set_result_cache_size(size_t entries) {
+    search_results.resize(entries);
+}
+
+void clear_result_cache() {
+    search_results.clear();
+}
+
+py::dict result_cache_info() {
+    py::dict result;
+    result["entries"] = search_results.entries();
+    result["capacity"] = search_results.capacity();
+    result["hits"] = search_results.hits.load();
+    result["seeded"] = search_results.seeded.load();
+    result["misses"] = search_results.misses.load();
+    return result;
+}
+
+std::vector<std::string> pv_to_uci(Position &pos, const std::vector<uint16_t> &pv) {
+    std::vector<std::string> result;
+    for (auto move : pv) {
+        result.push_back(pos.move_to_uci(move));
+    }
+    return result;
+}
+
+py::list to_list(const std::vector<std::string> &items) {
+    py::list result;
+    for (const auto &item : items) {
+        result.append(item);
+    }
+    return result;
+}
+
+// Skill levels below MAX_SKILL search a node budget that doubles every two
+// levels and pick among the best SKILL_MULTIPV lines
+const int MAX_SKILL = 20;
+const int SKILL_MULTIPV = 4;
+
+uint64_t skill_nodes(int skill) {
+    return 1000ull << (skill / 2);
+}
+
+// Picks one of the searched lines for a weakened level: each line gets a
+// random push that grows with the weakness and with how far it trails the
+// best line, so lower levels drift further from the best move. Mates are
+// always taken.
+size_t pick_skill_move(const std::vector<RootMove> &root_moves, size_t lines, int skill, std::mt19937_64 &rng) {
+    int top = root_moves[0].score;
+    if (top >= MATE_IN_MAX_PLY) return 0;
+
+    int weakness = 120 - 2 * skill;
+    int spread = std::min(top - root_moves[lines - 1].score, 100);
+    size_t chosen = 0;
+    int best_value = -1000000;
+
+    for (size_t i = 0; i < lines; i++) {
+        if (root_moves[i].score <= -MATE_IN_MAX_PLY) continue;
+
+        int push = (weakness * (top - root_moves[i].score) + spread * static_cast<int>(rng() % weakness)) / 128;
+        if (root_moves[i].score + push >= best_value) {
+            best_value = root_moves[i].score + push;
+            chosen = i;
+        }
+    }
+    return chosen;
+}
+
+// What get_best_move returns, kept out of Python objects so that
+// requests sharing one search can copy it without holding the GIL
+struct SearchLine {
+    std::string move;
+    int cp;
+    int mate;
+    std::vector<std::string> pv;
+};
+
+struct SearchResult {
+    std::string bestmove;
+    int cp = 0;
+    int mate = 0;
+    int depth = 0; // 0 when the move did not come from a search
+    uint64_t nodes = 0;
+    std::vector<std::string> pv;
+    std::vector<SearchLine> lines; // MultiPV only
+    std::string source;            // "book", "tablebase" or "cached"
+};
+
+py::dict to_dict(const SearchResult &search) {
+    py::dict result;
+    result["bestmove"] = search.bestmove;
+    result["cp"] = search.cp;
+    result["mate"] = search.mate;
+    if (!search.source.empty()) {
+        result[search.source.c_str()] = true;
+    }
+    if (search.depth > 0) {
+        result["depth"] = search.depth;
+        result["nodes"] = search.nodes;
+        result["pv"] = to_list(search.pv);
+    }
+    if (!search.lines.empty()) {
+        py::list multipv_lines;
+        for (const auto &line : search.lines) {
+            py::dict item;
+            item["move"] = line.move;
+            item["cp"] = line.cp;
+            item["mate"] = line.mate;
+            item["pv"] = to_list(line.pv);
+            multipv_lines.append(item);
+        }
+        result["lines"] = multipv_lines;
+    }
+    return result;
+}
+
+// Searches a position. Limits: time_ms (a hard stop; without a node budget
+// no iteration starts once most of it is spent), max_depth plies (0 for as
+// deep as the other limits allow), nodes (0 for none) and skill (0-19 for a
+// weakened level, MAX_SKILL for full strength). A weakened level's choice
+// only depends on the position and seed, never on the machine's load or the
+// searches before it: it runs isolated, and its few thousand nodes fit in
+// any sensible time_ms.
+// on_iteration, if set, gets the best line after every completed iteration.
+template <typename V>
+SearchResult search_position(const std::string &fen, int time_ms, bool use_book, int multipv,
+                             int max_depth, uint64_t nodes, int skill, uint64_t seed,
+                             const std::function<void(const SearchResult &)> &on_iteration) {
+    if constexpr (!V::ISOLATED) {
+        if (skill >= 0 && skill < MAX_SKILL) {
+            return search_position<policy::Isolated<V>>(fen, time_ms, use_book, multipv, max_depth, nodes, skill,
+                                                        seed, on_iteration);
+        }
+    }
+
     initialize_virgo();
     
     Position pos(fen);
@@ -225,28 +920,160 @@ py::dict get_best_move_cpp(const std::string &fen, int time_ms) {
     
     //std::cout << "Legal moves count: " << moves.size() << std::endl;
     
+    SearchResult result;
     if (moves.empty()) {
-        py::dict result;
-        result["bestmove"] = "";
-        result["cp"] = 0;
-        result["mate"] = 0;
         return result;
     }
 
+    if (use_book && opening_book.is_open()) {
+        std::mt19937_64 seeded_rng(pos.hash_position() ^ seed);
+        uint16_t move = opening_book.pick(pos.board, moves, true, V::ISOLATED ? seeded_rng : book_rng);
+        if (move != 0) {
+            result.bestmove = pos.move_to_uci(move);
+            result.source = "book";
+            return result;
+        }
+    }
+
+    int depth_limit = max_depth > 0 ? std::min(max_depth, search::MAX_PLY - 1) : search::MAX_PLY - 1;
+    bool weakened = skill >= 0 && skill < MAX_SKILL;
+
+    // No iteration starts once this share of time_ms is spent
+    const double LAST_ITERATION_TIME = 0.7;
+
+    // A result another request already searched answers this one when it went
+    // at least as deep, searched at least as many nodes for a node-limited
+    // request, or for a time-limited one ran at least as long as this search
+    // would before its last iteration. Its time is what it actually spent, so
+    // a search the scheduler shrunk only answers shorter requests. Otherwise
+    // its move is searched first.
+    uint64_t root_key = simple_hash(pos) ^ V::SALT;
+    result_cache::Result cached;
+    bool have_cached = !V::ISOLATED && search_results.lookup(root_key, cached) &&
+                       std::find(moves.begin(), moves.end(), cached.best_move) != moves.end();
+    if (have_cached && multipv <= 1 && !weakened &&
+        (cached.depth >= depth_limit || (max_depth <= 0 && nodes && cached.nodes >= nodes) ||
+         (max_depth <= 0 && !nodes && cached.time_ms >= time_ms * LAST_ITERATION_TIME))) {
+        search_results.hits++;
+        result.bestmove = pos.move_to_uci(cached.best_move);
+        result.cp = cached.score;
+        result.mate = mate_in(cached.score);
+        result.depth = cached.depth;
+        result.nodes = cached.nodes;
+        result.pv = pv_to_uci(pos, cached.pv);
+        result.source = "cached";
+        return result;
+    }
+    if (have_cached) {
+        search_results.seeded++;
+    } else {
+        search_results.misses++;
+    }
+
     auto start = std::chrono::steady_clock::now();
-    std::string best_move_uci;
     int best_eval = 0;
     uint16_t best_move = moves[0];
+    std::string best_move_uci = pos.move_to_uci(best_move);
+    int completed_depth = 0;
 
-    transposition_table.clear();
+    V::Table::new_search();
+    if (V::ISOLATED) {
+        tables.clear();
+    } else {
+        tables.new_search();
+    }
+    search::search_stack.clear();
+    node_count = 0;
+    node_limit = 0;
+    time_limited = false;
+    stop_time = start + std::chrono::milliseconds(time_ms);
+    stop_search = false;
 
-    for (int depth = 1; depth <= 8; ++depth) {
-        auto [current_eval, current_best_move] = negamax(pos, depth, -1000000, 1000000);
+    uint64_t node_budget = nodes;
+    int search_multipv = multipv;
+    if (weakened) {
+        node_budget = node_budget ? std::min(node_budget, skill_nodes(skill)) : skill_nodes(skill);
+        search_multipv = std::max(multipv, SKILL_MULTIPV);
+    }
 
-        if (current_best_move != 0) {
-            best_eval = current_eval;
-            best_move = current_best_move;
-            best_move_uci = pos.move_to_uci(best_move);
+    // The cached move, then captures that do not lose material, until node
+    // counts are known
+    std::vector<RootMove> root_moves;
+    for (auto move : moves) {
+        bool capture = pos.board.piece_on(MOVE_TO(move)) != virgo::EMPTY;
+        uint64_t order = (have_cached && move == cached.best_move) ? 2 : (capture && pos.see(move) >= 0) ? 1 : 0;
+        root_moves.push_back({move, 0, order, {}});
+    }
+    std::stable_sort(root_moves.begin(), root_moves.end(),
+                     [](const RootMove &a, const RootMove &b) { return a.nodes > b.nodes; });
+
+    const int ASPIRATION_WINDOW = 50;
+    const int ASPIRATION_DEPTH = 4;
+    size_t lines = std::min<size_t>(std::max(search_multipv, 1), root_moves.size());
+
+    for (int depth = 1; depth <= depth_limit; ++depth) {
+        // The first iteration always completes, so there is a move to play;
+        // later ones are cut off at the node budget or when time_ms is up
+        node_limit = (depth > 1) ? node_budget : 0;
+        time_limited = depth > 1;
+        std::vector<RootMove> completed_moves;
+        if (node_limit || time_limited) {
+            completed_moves = root_moves;
+        }
+
+        // MultiPV: each line searches the moves not yet taken by a better
+        // line, so the first N root moves end up with exact scores
+        for (size_t pv_index = 0; pv_index < lines; pv_index++) {
+            // Aspiration: search a window around the line's last score,
+            // widening it exponentially on the side that failed. Entries from
+            // the failed searches stay in the TT and speed up the re-search.
+            int previous_eval = root_moves[pv_index].score;
+            int delta = ASPIRATION_WINDOW;
+            int alpha = -1000000, beta = 1000000;
+            if (depth >= ASPIRATION_DEPTH && abs(previous_eval) < 9000) {
+                alpha = previous_eval - delta;
+                beta = previous_eval + delta;
+            }
+
+            while (true) {
+                int current_eval = search_root<V>(pos, root_moves, pv_index, depth, alpha, beta);
+
+                if (current_eval <= alpha && alpha > -1000000) {
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(current_eval - delta, -1000000);
+                } else if (current_eval >= beta && beta < 1000000) {
+                    beta = std::min(current_eval + delta, 1000000);
+                } else {
+                    break;
+                }
+                delta *= 2;
+            }
+        }
+
+        // An interrupted iteration is thrown away
+        if (stop_search) {
+            root_moves = std::move(completed_moves);
+            break;
+        }
+
+        // A later line can turn out better than an earlier one at this depth
+        std::stable_sort(root_moves.begin(), root_moves.begin() + lines,
+                         [](const RootMove &a, const RootMove &b) { return a.score > b.score; });
+
+        best_eval = root_moves[0].score;
+        best_move = root_moves[0].move;
+        best_move_uci = pos.move_to_uci(best_move);
+        completed_depth = depth;
+
+        if (on_iteration) {
+            SearchResult progress;
+            progress.bestmove = best_move_uci;
+            progress.cp = best_eval;
+            progress.mate = mate_in(best_eval);
+            progress.depth = depth;
+            progress.nodes = node_count;
+            progress.pv = pv_to_uci(pos, root_moves[0].pv);
+            on_iteration(progress);
         }
 
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -255,24 +1082,319 @@ py::dict get_best_move_cpp(const std::string &fen, int time_ms) {
         /* std::cout << "Depth " << depth << " completed in " << elapsed.count() 
                   << "ms. Best move: " << best_move_uci << " eval: " << best_eval << std::endl; */
 
-        if (elapsed.count() > time_ms * 0.7) {
+        if (!node_budget && elapsed.count() > time_ms * LAST_ITERATION_TIME) {
             //std::cout << "Breaking due to time constraints" << std::endl;
             break;
         }
 
-        if (abs(best_eval) > 9000) {
+        // A mate is only the shortest once every shorter line has been searched
+        if (abs(best_eval) >= MATE_IN_MAX_PLY && MATE_SCORE - abs(best_eval) <= depth) {
             //std::cout << "Breaking due to mate found" << std::endl;
             break;
         }
     }
 
+    // The full-strength result of a completed iteration, whichever line the
+    // skill level plays
+    if (completed_depth > 0) {
+        int spent_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            std::chrono::steady_clock::now() - start).count());
+        search_results.store(root_key, {root_moves[0].move, root_moves[0].score, completed_depth, node_count,
+                                        spent_ms, root_moves[0].pv});
+    }
+
+    size_t chosen = 0;
+    if (weakened) {
+        std::mt19937_64 skill_rng(pos.hash_position() ^ seed);
+        chosen = pick_skill_move(root_moves, lines, skill, skill_rng);
+        best_eval = root_moves[chosen].score;
+        best_move_uci = pos.move_to_uci(root_moves[chosen].move);
+    }
+
+    result.bestmove = best_move_uci;
+    result.cp = best_eval;
+    result.mate = mate_in(best_eval);
+    result.depth = completed_depth;
+    result.nodes = node_count;
+    result.pv = pv_to_uci(pos, root_moves[chosen].pv);
+
+    if (multipv > 1) {
+        for (size_t i = 0; i < std::min<size_t>(multipv, lines); i++) {
+            result.lines.push_back({pos.move_to_uci(root_moves[i].move), root_moves[i].score,
+                                    mate_in(root_moves[i].score), pv_to_uci(pos, root_moves[i].pv)});
+        }
+    }
+    return result;
+}
+
+// A shed request still gets a legal move: a cached result if there is one,
+// else a one-ply search
+template <typename V>
+SearchResult fallback_move(const std::string &fen, bool use_book, int skill, uint64_t seed) {
+    SearchResult result = search_position<V>(fen, 0, use_book, 1, 1, 0, skill, seed, nullptr);
+    if (result.source.empty() && !result.bestmove.empty()) {
+        result.source = "fallback";
+    }
+    return result;
+}
+
+// Tablebase probes take the GIL, so a request makes them on its own thread
+// before it queues a search: perfect play when the root is already in range,
+// else the positions the search may reach the tables in. MultiPV analysis
+// searches the root instead, to score the other moves too. Returns true with
+// result set when the tables pick the move.
+bool probe_tablebases(Position &pos, int multipv, SearchResult &result) {
+    auto lock = share_search();
+    if (!tablebases.is_open()) return false;
+
+    auto moves = pos.get_legal_moves();
+    if (multipv <= 1 && !moves.empty() && tablebases.in_range(pos)) {
+        int tb_score;
+        uint16_t move = tablebases.probe_root(pos, moves, tb_score);
+        if (move != 0) {
+            result.bestmove = pos.move_to_uci(move);
+            result.cp = tb_score;
+            result.source = "tablebase";
+            return true;
+        }
+    }
+    tablebases.probe_ahead(pos);
+    return false;
+}
+
+// Engine variants, each compiled from the same search with its own policies.
+// SALT keeps their cached and in-flight results apart.
+
+// The engine as played on the site
+struct Standard : policy::Variant<policy::DefaultEval, policy::FullPruning, policy::HistoryOrdering, SharedTable> {
+    static constexpr uint64_t SALT = 0;
+};
+
+// Plain PVS on the classic evaluation with captures-first ordering, the
+// baseline the other variants are measured against
+struct Basic : policy::Variant<policy::ClassicEval, policy::NoPruning, policy::CaptureOrdering, policy::OwnTable<struct Basic>> {
+    static constexpr uint64_t SALT = 0x6a09e667f3bcc908ull;
+};
+
+// Standard without the leaf pruning, to measure what it gains
+struct Unpruned : policy::Variant<policy::DefaultEval, policy::NoPruning, policy::HistoryOrdering, policy::OwnTable<struct Unpruned>> {
+    static constexpr uint64_t SALT = 0xbb67ae8584caa73bull;
+};
+
+// Requests for the same position and limits share one search, which runs on
+// the scheduler's workers without the GIL
+static coalesce::Coalescer<SearchResult> in_flight;
+static scheduler::Scheduler search_scheduler;
+
+template <typename V>
+py::dict get_best_move(const std::string &fen, int time_ms, bool use_book, int multipv,
+                       int max_depth, uint64_t nodes, int skill, uint64_t seed) {
+    initialize_virgo();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_ms);
+
+    // time_ms is left out of the key: a time or depth limited caller with
+    // less time than the search it joins leaves at its own deadline with the
+    // best line so far
+    Position pos(fen);
+    uint64_t key = simple_hash(pos) ^ V::SALT;
+    for (uint64_t limit : {static_cast<uint64_t>(use_book), static_cast<uint64_t>(multipv), static_cast<uint64_t>(max_depth),
+                           nodes, static_cast<uint64_t>(skill), seed}) {
+        key = (key ^ limit) * 0x9e3779b97f4a7c15ull;
+    }
+
+    // A node budget or weakened level plays the same move whatever the load,
+    // so the scheduler never shrinks or sheds it
+    bool exact = nodes || (skill >= 0 && skill < MAX_SKILL);
+
+    SearchResult result;
+    if (probe_tablebases(pos, multipv, result)) {
+        return to_dict(result);
+    }
+    {
+        py::gil_scoped_release release;
+        bool leader;
+        auto flight = in_flight.join(key, leader);
+        if (leader) {
+            auto search = [&](int budget_ms) {
+                std::shared_lock<std::shared_mutex> lock(search_mutex);
+                result = search_position<V>(fen, budget_ms, use_book, multipv, max_depth, nodes, skill, seed,
+                                         [&](const SearchResult &progress) { in_flight.progress(*flight, progress); });
+            };
+            auto fallback = [&] {
+                std::shared_lock<std::shared_mutex> lock(search_mutex);
+                result = fallback_move<V>(fen, use_book, skill, seed);
+            };
+            try {
+                search_scheduler.run(deadline, time_ms, exact, search, fallback);
+            } catch (...) {
+                // Whoever waits on this search must not wait forever
+                in_flight.finish(key, *flight, result);
+                throw;
+            }
+            in_flight.finish(key, *flight, result);
+        } else if (!exact) {
+            result = in_flight.wait(*flight, deadline);
+        } else {
+            // Node budgets and weakened levels promise the move a search of
+            // their own would play, so they wait for the final one; the
+            // search still stops at its time_ms
+            result = in_flight.wait(*flight);
+        }
+    }
+    return to_dict(result);
+}
+
+// threads search workers, 0 for one per core, and at most max_queue searches
+// waiting for them, 0 for QUEUE_PER_WORKER per worker. Waits for the
+// searches already running; requests arriving meanwhile get the fallback. The
+// module starts with one worker per core.
+void set_search_threads(size_t threads, size_t max_queue) {
+    py::gil_scoped_release release;
+    search_scheduler.start(threads, max_queue);
+}
+
+py::dict scheduler_info() {
+    auto stats = search_scheduler.stats();
+    py::dict result;
+    result["workers"] = stats.workers;
+    result["queued"] = stats.queued;
+    result["max_queue"] = stats.max_queue;
+    result["completed"] = stats.completed;
+    result["shed"] = stats.shed;
+    result["shrunk"] = stats.shrunk;
+    result["late"] = stats.late;
+    result["avg_wait_ms"] = stats.completed + stats.shed ? stats.wait_ms / (stats.completed + stats.shed) : 0;
+    result["avg_search_ms"] = stats.completed ? stats.search_ms / stats.completed : 0;
+    return result;
+}
+
+py::dict coalesce_info() {
     py::dict result;
-    result["bestmove"] = best_move_uci;
-    result["cp"] = best_eval;
-    result["mate"] = 0;
+    result["joined"] = in_flight.joined.load();
+    result["early"] = in_flight.early.load();
+    return result;
+}
+
+// Mate solver for puzzle validation: the shortest forced mate within
+// max_moves moves. "mate" is 0 when none exists, or when the node budget ran
+// out first ("complete" is then False).
+py::dict find_mate_cpp(const std::string &fen, int max_moves, bool checks_only, uint64_t max_nodes) {
+    initialize_virgo();
+
+    Position pos(fen);
+    mate_solver::Solver solver(checks_only, max_nodes);
+    std::vector<uint16_t> line;
+    int mate;
+    {
+        // A failed proof can run to max_nodes; other Python threads carry on
+        py::gil_scoped_release release;
+        mate = solver.solve(pos, max_moves, line);
+    }
+
+    py::dict result;
+    result["mate"] = mate;
+    result["bestmove"] = line.empty() ? std::string() : pos.move_to_uci(line[0]);
+    result["pv"] = to_list(pv_to_uci(pos, line));
+    result["nodes"] = solver.nodes();
+    result["complete"] = mate != 0 || !solver.aborted();
+    return result;
+}
+
+// Sets one of the pruning options by name; false for an unknown name
+bool set_search_option(const std::string &name, int value) {
+    auto lock = pause_search();
+    static const std::unordered_map<std::string, int SearchOptions::*> fields = {
+        {"rfp_depth", &SearchOptions::rfp_depth},
+        {"rfp_margin", &SearchOptions::rfp_margin},
+        {"razor_depth", &SearchOptions::razor_depth},
+        {"razor_margin", &SearchOptions::razor_margin},
+        {"futility_depth", &SearchOptions::futility_depth},
+        {"futility_margin", &SearchOptions::futility_margin},
+        {"lmp_depth", &SearchOptions::lmp_depth},
+        {"lmp_base", &SearchOptions::lmp_base},
+    };
+
+    auto it = fields.find(name);
+    if (it == fields.end()) return false;
+
+    search_options.*(it->second) = value;
+    init_lmp_table();
+    search_results.clear();
+    return true;
+}
+
+py::dict get_search_options() {
+    py::dict result;
+    result["rfp_depth"] = search_options.rfp_depth;
+    result["rfp_margin"] = search_options.rfp_margin;
+    result["razor_depth"] = search_options.razor_depth;
+    result["razor_margin"] = search_options.razor_margin;
+    result["futility_depth"] = search_options.futility_depth;
+    result["futility_margin"] = search_options.futility_margin;
+    result["lmp_depth"] = search_options.lmp_depth;
+    result["lmp_base"] = search_options.lmp_base;
     return result;
 }
 
 PYBIND11_MODULE(engine_core, m) {
-    m.def("get_best_move_cpp", &get_best_move_cpp, "Get best move using Virgo board logic");
+    m.def("get_best_move_cpp", &get_best_move<Standard>, "Get best move using Virgo board logic",
+          py::arg("fen"), py::arg("time_ms"), py::arg("use_book") = true, py::arg("multipv") = 1,
+          py::arg("max_depth") = 0, py::arg("nodes") = 0, py::arg("skill") = MAX_SKILL, py::arg("seed") = 0);
+    m.def("get_best_move_basic", &get_best_move<Basic>, "get_best_move_cpp with plain PVS, classic eval and no history heuristics",
+          py::arg("fen"), py::arg("time_ms"), py::arg("use_book") = true, py::arg("multipv") = 1,
+          py::arg("max_depth") = 0, py::arg("nodes") = 0, py::arg("skill") = MAX_SKILL, py::arg("seed") = 0);
+    m.def("get_best_move_unpruned", &get_best_move<Unpruned>, "get_best_move_cpp without the leaf pruning",
+          py::arg("fen"), py::arg("time_ms"), py::arg("use_book") = true, py::arg("multipv") = 1,
+          py::arg("max_depth") = 0, py::arg("nodes") = 0, py::arg("skill") = MAX_SKILL, py::arg("seed") = 0);
+    m.def("load_book", &load_book, "Memory-map a Polyglot .bin opening book",
+          py::arg("path"), py::arg("random64"));
+    m.def("unload_book", &unload_book, "Unmap the opening book");
+    m.def("book_moves", &book_moves, "List the book moves and weights for a position");
+    m.def("load_tablebases", &load_tablebases, "Open Syzygy tablebases from a directory list",
+          py::arg("path"), py::arg("max_pieces") = 5, py::arg("probe_depth") = 2);
+    m.def("set_tablebase_pieces", &set_tablebase_pieces, "Limit tablebase probing to this many pieces");
+    m.def("load_nnue", &load_nnue, "Load HalfKP NNUE weights and switch evaluation to them");
+    m.def("set_nnue", &set_nnue, "Switch between NNUE (True) and the classic evaluation (False)");
+    m.def("evaluate_cpp", &evaluate_position, "Static evaluation from the side to move's point of view",
+          py::arg("fen"));
+    m.def("perft_cpp", &perft_position, "Count the leaves of the legal move tree to a depth",
+          py::arg("fen"), py::arg("depth"));
+    m.def("book_move", &book_move, "Pick a book move, empty string when out of book",
+          py::arg("fen"), py::arg("weighted") = true);
+    m.def("find_mate_cpp", &find_mate_cpp, "Prove the shortest forced mate within max_moves moves",
+          py::arg("fen"), py::arg("max_moves"), py::arg("checks_only") = false, py::arg("max_nodes") = 10000000);
+    m.def("set_search_option", &set_search_option, "Set a pruning margin or depth limit by name",
+          py::arg("name"), py::arg("value"));
+    m.def("get_search_options", &get_search_options, "Current pruning margins and depth limits");
+    m.def("set_hash_size", &set_hash_size, "Use private transposition tables of about this many MB, the variants' own ones too",
+          py::arg("mb"));
+    m.def("attach_shared_hash", &attach_shared_hash, "Share the transposition table through a named shared-memory segment",
+          py::arg("name"), py::arg("mb") = tt::Table::DEFAULT_MB);
+    m.def("clear_hash", &clear_hash, "Clear the transposition tables, shared or not");
+    m.def("hash_info", &hash_info, "Size of the transposition table and whether it is shared");
+    m.def("save_hash_snapshot", &save_hash_snapshot, "Write the deeper transposition table entries to a snapshot file",
+          py::arg("path"), py::arg("min_depth") = 4);
+    m.def("load_hash_snapshot", &load_hash_snapshot, "Memory-map a transposition table snapshot, probed on table misses",
+          py::arg("path"));
+    m.def("set_result_cache_size", &set_result_cache_size, "Bound the cross-request result cache to this many positions",
+          py::arg("entries"));
+    m.def("clear_result_cache", &clear_result_cache, "Forget every cached search result");
+    m.def("set_search_threads", &set_search_threads, "Size the search worker pool, 0 for one thread per core",
+          py::arg("threads") = 0, py::arg("max_queue") = 0);
+    m.def("scheduler_info", &scheduler_info, "Workers, queue length and shed, shrunk and late search counts");
+    m.def("coalesce_info", &coalesce_info, "How many requests shared another's search, and how many left it early");
+    m.def("result_cache_info", &result_cache_info, "Size of the result cache and its hit, seed and miss counts");
+
+    search_scheduler.start(0);
+
+    // The workers and the tables (which hold python-chess objects) go while
+    // the interpreter is still alive rather than in the static destructors
+    py::module_::import("atexit").attr("register")(py::cpp_function([]() {
+        {
+            py::gil_scoped_release release;
+            search_scheduler.stop();
+        }
+        auto lock = pause_search();
+        tablebases.close();
+    }));
 }
\ No newline at end of file
@@ -1,6 +1,159 @@
 # engine_strong_cpp.py
 import engine_core
 
+def load_book(path: str) -> bool:
+    """
+    Memory-maps a Polyglot .bin opening book into the C++ engine.
+    The Polyglot Random64 key table comes from python-chess.
+    """
+    try:
+        import chess.polyglot
+        return engine_core.load_book(path, chess.polyglot.POLYGLOT_RANDOM_ARRAY)
+    except Exception as e:
+        print(f"Error loading book: {e}")
+        return False
+
+def load_tablebases(path: str, max_pieces: int = 5, probe_depth: int = 2) -> bool:
+    """
+    Enables Syzygy probing from one or more directories (os.pathsep separated).
+    Positions with more than max_pieces pieces are searched normally. Probes
+    run on the request thread before the search, for the positions up to
+    probe_depth captures or pawn moves ahead; the search reads their results.
+    """
+    try:
+        return engine_core.load_tablebases(path, max_pieces, probe_depth)
+    except Exception as e:
+        print(f"Error loading tablebases: {e}")
+        return False
+
+def load_nnue(path: str) -> bool:
+    """
+    Loads HalfKP .nnue weights; the engine evaluates with them until
+    set_nnue(False) switches back to the classic evaluation.
+    """
+    try:
+        return engine_core.load_nnue(path)
+    except Exception as e:
+        print(f"Error loading NNUE: {e}")
+        return False
+
+def set_nnue(enabled: bool):
+    engine_core.set_nnue(enabled)
+
+def attach_shared_hash(name: str, mb: int = 16) -> bool:
+    """
+    Backs the transposition table with a POSIX shared-memory segment, so every
+    worker process attaching to the same name shares one warm table.
+    The first process creates it with mb megabytes; later ones reuse it.
+    """
+    try:
+        return engine_core.attach_shared_hash(name, mb)
+    except Exception as e:
+        print(f"Error attaching shared hash: {e}")
+        return False
+
+def set_hash_size(mb: int) -> bool:
+    return engine_core.set_hash_size(mb)
+
+def load_hash_snapshot(path: str) -> bool:
+    """
+    Memory-maps a transposition table snapshot; pages load as the search needs them
+    """
+    try:
+        return engine_core.load_hash_snapshot(path)
+    except Exception as e:
+        print(f"Error loading hash snapshot: {e}")
+        return False
+
+def save_hash_snapshot(path: str, min_depth: int = 4) -> int:
+    """
+    Writes the entries searched to at least min_depth for the next start.
+    Returns the number of entries written, -1 on error.
+    """
+    try:
+        return engine_core.save_hash_snapshot(path, min_depth)
+    except Exception as e:
+        print(f"Error saving hash snapshot: {e}")
+        return -1
+
+def set_result_cache_size(entries: int):
+    """
+    Bounds the cache of finished searches shared by all requests; 0 turns it off
+    """
+    engine_core.set_result_cache_size(entries)
+
+def result_cache_info():
+    """
+    Returns: {"entries": 812, "capacity": 65536, "hits": 5040, "seeded": 97, "misses": 812}
+    hits were answered without searching, seeded searched the cached move first
+    """
+    return dict(engine_core.result_cache_info())
+
+def set_search_threads(threads: int = 0, max_queue: int = 0):
+    """
+    Sizes the native search pool: threads workers (0 for one per core) and at
+    most max_queue searches waiting (0 for 8 per worker). Searches past the
+    queue, or left without time to search, get a one-ply fallback move.
+    """
+    engine_core.set_search_threads(threads, max_queue)
+
+def scheduler_info():
+    """
+    Returns: {"workers": 8, "queued": 3, "max_queue": 64, "completed": 9120,
+              "shed": 12, "shrunk": 340, "late": 4, "avg_wait_ms": 6, "avg_search_ms": 131}
+    """
+    return dict(engine_core.scheduler_info())
+
+def coalesce_info():
+    """
+    Returns: {"joined": 31, "early": 2}
+    joined requests waited on an identical search already running instead of
+    starting their own; early ones left at their deadline with its latest line
+    """
+    return dict(engine_core.coalesce_info())
+
+def set_search_option(name: str, value: int) -> bool:
+    """
+    Tunes the leaf pruning, e.g. set_search_option("futility_margin", 150).
+    Returns False for an unknown option; see engine_core.get_search_options().
+    """
+    return engine_core.set_search_option(name, value)
+
+def get_book_move(fen: str, weighted: bool = True):
+    """
+    Returns a book move in UCI, or None when the position is out of book
+    """
+    move = engine_core.book_move(fen, weighted)
+    return move or None
+
+def analyse(fen: str, time_ms: int = 1000, multipv: int = 3):
+    """
+    Scores the best multipv moves in one search.
+    Returns: [{"move": "e2e4", "cp": 35, "pv": ["e2e4", "e7e5", ...]}, ...], best first
+    """
+    try:
+        result = engine_core.get_best_move_cpp(fen, time_ms, False, multipv)
+        if "lines" in result:
+            return [dict(line) for line in result["lines"]]
+        if not result["bestmove"]:
+            return []
+        return [{"move": result["bestmove"], "cp": result["cp"], "pv": list(result.get("pv", []))}]
+    except Exception as e:
+        print(f"Error in engine: {e}")
+        return []
+
+def find_mate(fen: str, max_moves: int, checks_only: bool = False, max_nodes: int = 10_000_000):
+    """
+    Proves the shortest forced mate within max_moves moves, for puzzle validation.
+    Returns: {"mate": 3, "bestmove": "f6a6", "pv": [...], "nodes": 472, "complete": True}
+    mate is 0 when there is none, or when max_nodes ran out first (complete False).
+    """
+    try:
+        return dict(engine_core.find_mate_cpp(fen, max_moves, checks_only, max_nodes))
+    except Exception as e:
+        print(f"Error in mate solver: {e}")
+        return {"mate": 0, "bestmove": "", "pv": [], "nodes": 0, "complete": False}
+
 def get_best_move_sp(fen: str, time_ms: int = 2000):
     try:
         result = engine_core.get_best_move_cpp(fen, time_ms)
@@ -11,13 +164,14 @@ def get_best_move_sp(fen: str, time_ms: int = 2000):
         print(f"Error in engine: {e}")
         return "0000"  # resignation
     
-def get_best_move(fen: str, time_ms: int = 2000):
+def get_best_move(fen: str, time_ms: int = 2000, depth: int = 0, nodes: int = 0, skill: int = 20):
     """
     Calls C++ engine
+    depth and nodes cap the search when non-zero; skill 0-20 weakens play
     Returns: {"bestmove": "e2e4", "cp": 35, "mate": 0}
     """
     try:
-        result = engine_core.get_best_move_cpp(fen, time_ms)
+        result = engine_core.get_best_move_cpp(fen, time_ms, max_depth=depth, nodes=nodes, skill=skill)
         return {
             "bestmove": result["bestmove"],
             "cp": result["cp"],
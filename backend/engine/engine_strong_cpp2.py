@@ -1,16 +1,17 @@
 
-import engine_core2
+import engine_core
 
-def get_best_move(fen: str, time_ms: int = 2000):
+def get_best_move(fen: str, time_ms: int = 2000, variant: str = "basic"):
     """
-    Calls C++ engine
-    Returns: {"bestmove": "e2e4", "cp": 35, "mate": 0}
+    Calls one of the C++ engine's experimental variants ("basic" or "unpruned"),
+    built from the same search as get_best_move_cpp, for A/B games against it
+    Returns: the move in UCI, "0000" on error
     """
     try:
-        result = engine_core2.get_best_move_cpp(fen, time_ms)
+        result = getattr(engine_core, f"get_best_move_{variant}")(fen, time_ms)
         best_move_uci = result["bestmove"]
         print(f"Engine chose: {best_move_uci} with eval: {result['cp']}")
         return best_move_uci
     except Exception as e:
         print(f"Error in engine: {e}")
-        return "0000"  # resignation
\ No newline at end of file
+        return "0000"  # resignation
@@ -0,0 +1,153 @@
+// mate_solver.h
+#pragma once
+#include "board_adapter.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mate_solver {
+
+// Proves or refutes a forced mate for the side to move without evaluating
+// anything: the attacker needs one move that mates against every defence.
+// With checks_only the attacker only tries checking moves, which finds the
+// usual puzzle mates much faster but misses mates with a quiet move.
+class Solver {
+public:
+    Solver(bool checks_only, uint64_t max_nodes) : checks_only(checks_only), max_nodes(max_nodes) {}
+
+    // Shortest mate in at most max_moves moves, 0 if none was found.
+    // The mating line is left in pv.
+    int solve(board_adapter::Position &pos, int max_moves, std::vector<uint16_t> &pv) {
+        pv.clear();
+        for (int moves = 1; moves <= max_moves && !aborted(); moves++) {
+            uint16_t best = 0;
+            if (attack(pos, moves, best)) {
+                extract_pv(pos, moves, pv);
+                return moves;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t nodes() const { return node_count; }
+    bool aborted() const { return node_count >= max_nodes; }
+
+private:
+    // What is known about an attacker node: mate in proven moves, or no
+    // mate in refuted moves. 0 means unknown.
+    struct Entry {
+        int proven = 0;
+        int refuted = 0;
+        uint16_t move = 0;
+    };
+
+    // Can the side to move mate in at most moves moves
+    bool attack(board_adapter::Position &pos, int moves, uint16_t &best) {
+        node_count++;
+        uint64_t key = pos.hash_position();
+        Entry &known = cache[key];
+        if (known.proven && known.proven <= moves) {
+            best = known.move;
+            return true;
+        }
+        if (known.refuted >= moves || aborted()) return false;
+
+        // Checks first, they leave the defender the fewest replies
+        std::vector<uint16_t> checks, quiets;
+        for (auto move : pos.get_legal_moves()) {
+            pos.make_move(move);
+            bool check = pos.is_in_check();
+            pos.undo_move();
+            if (check) checks.push_back(move);
+            else if (!checks_only && moves > 1) quiets.push_back(move);
+        }
+        checks.insert(checks.end(), quiets.begin(), quiets.end());
+
+        for (auto move : checks) {
+            pos.make_move(move);
+            bool mates = defend(pos, moves);
+            pos.undo_move();
+            if (mates) {
+                // cache may have rehashed during the search
+                Entry &entry = cache[key];
+                entry.proven = moves;
+                entry.move = move;
+                best = move;
+                return true;
+            }
+        }
+
+        if (!aborted()) {
+            Entry &entry = cache[key];
+            entry.refuted = std::max(entry.refuted, moves);
+        }
+        return false;
+    }
+
+    // After an attacker move: does every reply still lose within moves - 1 more moves
+    bool defend(board_adapter::Position &pos, int moves) {
+        node_count++;
+        auto replies = pos.get_legal_moves();
+        if (replies.empty()) return pos.is_in_check();
+        if (moves == 1) return false;
+
+        for (auto reply : replies) {
+            pos.make_move(reply);
+            uint16_t best = 0;
+            bool mated = attack(pos, moves - 1, best);
+            pos.undo_move();
+            if (!mated) return false;
+        }
+        return true;
+    }
+
+    // Mating line: the proven attacker moves against the defence that lasts longest
+    void extract_pv(board_adapter::Position &pos, int moves, std::vector<uint16_t> &pv) {
+        int made = 0;
+        while (moves > 0) {
+            uint16_t best = 0;
+            if (!attack(pos, moves, best) || best == 0) break;
+            pos.make_move(best);
+            made++;
+            pv.push_back(best);
+
+            auto replies = pos.get_legal_moves();
+            if (replies.empty()) break;
+
+            uint16_t longest = replies[0];
+            int longest_moves = 0;
+            for (auto reply : replies) {
+                pos.make_move(reply);
+                int needed = moves - 1;
+                uint16_t unused = 0;
+                for (int n = 1; n < moves; n++) {
+                    if (attack(pos, n, unused)) {
+                        needed = n;
+                        break;
+                    }
+                }
+                pos.undo_move();
+                if (needed > longest_moves) {
+                    longest_moves = needed;
+                    longest = reply;
+                }
+            }
+
+            pos.make_move(longest);
+            made++;
+            pv.push_back(longest);
+            moves = longest_moves;
+        }
+
+        while (made-- > 0) {
+            pos.undo_move();
+        }
+    }
+
+    bool checks_only;
+    uint64_t max_nodes;
+    uint64_t node_count = 0;
+    std::unordered_map<uint64_t, Entry> cache;
+};
+
+}  // namespace mate_solver
@@ -0,0 +1,111 @@
+// move_ordering.h
+#pragma once
+#include "virgo/virgo.h"
+#include "search_stack.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace move_ordering {
+
+constexpr int MAX_HISTORY = 16384;
+
+// Losing captures are ordered from here down by their SEE loss, below any
+// quiet move: those score at least -3 * MAX_HISTORY / 100 plus the -200
+// repetition penalty
+constexpr int LOSING_CAPTURE = -2000;
+
+// piece index used by the tables: color * 6 + virgo::Piece, NO_PIECE for a null move
+constexpr int NO_PIECE = -1;
+
+inline int piece_index(virgo::Player color, virgo::Piece piece) {
+    return color * 6 + piece;
+}
+
+// Gravity update: the more saturated an entry is, the less a bonus moves it,
+// so scores stay within +-MAX_HISTORY and recent results keep counting
+inline void update_stat(int16_t &entry, int bonus) {
+    int value = entry;
+    value += bonus - value * std::abs(bonus) / MAX_HISTORY;
+    entry = static_cast<int16_t>(value);
+}
+
+inline int stat_bonus(int depth) {
+    return std::min(32 * depth * depth, 2048);
+}
+
+// Quiet move ordering statistics, one set per search thread: butterfly
+// history, counter moves and continuation history. Killers and the moves of
+// the current line live in the search stack.
+struct Tables {
+    int16_t history[2][64][64];                  // [color][from][to]
+    uint16_t counter_moves[12][64];              // reply to [piece][to] of the previous move
+    int16_t continuation[2][12][64][12][64];     // [plies back - 1][earlier piece][to][piece][to]
+
+    void clear() { std::memset(this, 0, sizeof(*this)); }
+
+    // Histories are halved between searches so old games fade out
+    void new_search() {
+        for (auto &by_color : history)
+            for (auto &by_from : by_color)
+                for (auto &entry : by_from) entry /= 2;
+        for (auto &by_distance : continuation)
+            for (auto &by_piece : by_distance)
+                for (auto &by_square : by_piece)
+                    for (auto &row : by_square)
+                        for (auto &entry : row) entry /= 2;
+    }
+
+    uint16_t counter_move(const search::SearchStack *ss) const {
+        const search::SearchStack *prev = ss - 1;
+        return prev->moved_piece == NO_PIECE ? 0 : counter_moves[prev->moved_piece][MOVE_TO(prev->current_move)];
+    }
+
+    // Combined history of a quiet move
+    int quiet_score(const search::SearchStack *ss, virgo::Player color, int piece, uint16_t move) const {
+        int to = MOVE_TO(move);
+        int score = history[color][MOVE_FROM(move)][to];
+        for (int n = 1; n <= 2; n++) {
+            const search::SearchStack *prev = ss - n;
+            if (prev->moved_piece != NO_PIECE) {
+                score += continuation[n - 1][prev->moved_piece][MOVE_TO(prev->current_move)][piece][to];
+            }
+        }
+        return score;
+    }
+
+    // After a quiet beta cutoff: reward the move, penalise the quiets tried before it
+    void update_quiet(search::SearchStack *ss, int depth, virgo::Player color, int piece, uint16_t move,
+                      const uint16_t *tried_moves, const int *tried_pieces, int tried_count) {
+        if (ss->killers[0] != move) {
+            ss->killers[1] = ss->killers[0];
+            ss->killers[0] = move;
+        }
+
+        const search::SearchStack *prev = ss - 1;
+        if (prev->moved_piece != NO_PIECE) counter_moves[prev->moved_piece][MOVE_TO(prev->current_move)] = move;
+
+        int bonus = stat_bonus(depth);
+        update_quiet_stats(ss, color, piece, move, bonus);
+        for (int i = 0; i < tried_count; i++) {
+            update_quiet_stats(ss, color, tried_pieces[i], tried_moves[i], -bonus);
+        }
+    }
+
+private:
+    void update_quiet_stats(const search::SearchStack *ss, virgo::Player color, int piece, uint16_t move, int bonus) {
+        int to = MOVE_TO(move);
+        update_stat(history[color][MOVE_FROM(move)][to], bonus);
+        for (int n = 1; n <= 2; n++) {
+            const search::SearchStack *prev = ss - n;
+            if (prev->moved_piece != NO_PIECE) {
+                update_stat(continuation[n - 1][prev->moved_piece][MOVE_TO(prev->current_move)][piece][to], bonus);
+            }
+        }
+    }
+};
+
+inline thread_local Tables tables;
+
+}  // namespace move_ordering
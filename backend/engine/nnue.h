@@ -0,0 +1,401 @@
+// nnue.h
+#pragma once
+#include "virgo/virgo.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+// NNUE evaluation for HalfKP 256x2-32-32-1 networks (the Stockfish 12 .nnue
+// format). The feature transformer output is kept in an accumulator per ply
+// and updated from the pieces a move touched; only king moves refresh it.
+namespace nnue {
+
+constexpr uint32_t FILE_VERSION = 0x7AF32F16u;
+
+constexpr int HALF_DIMENSIONS = 256;
+constexpr int PS_END = 10 * 64 + 1;            // piece-square features per king square
+constexpr int INPUT_DIMENSIONS = 64 * PS_END;
+constexpr int HIDDEN1 = 32;
+constexpr int HIDDEN2 = 32;
+constexpr int WEIGHT_SCALE_BITS = 6;
+constexpr int OUTPUT_SCALE = 16;
+constexpr int PAWN_VALUE = 208;                // internal units of one pawn
+
+// Pieces added or removed by one move; from or to is 64 when the piece
+// appears (promotion) or disappears (capture)
+struct DirtyPiece {
+    int count;
+    virgo::Piece piece[3];
+    virgo::Player color[3];
+    int from[3];
+    int to[3];
+
+    void add(virgo::Piece p, virgo::Player c, int f, int t) {
+        piece[count] = p;
+        color[count] = c;
+        from[count] = f;
+        to[count] = t;
+        count++;
+    }
+};
+
+struct alignas(64) Accumulator {
+    int16_t values[2][HALF_DIMENSIONS];
+    bool computed;
+    bool king_moved[2];
+    DirtyPiece dirty;
+};
+
+// One accumulator per ply of the current line
+class AccumulatorStack {
+public:
+    AccumulatorStack() : stack(1), top(0) {
+        stack[0].computed = false;
+    }
+
+    Accumulator &current() { return stack[top]; }
+
+    Accumulator *previous() { return top > 0 ? &stack[top - 1] : nullptr; }
+
+    // Records what a move is about to change; call before the board is updated
+    void push(virgo::Chessboard &board, uint16_t move) {
+        if (++top == static_cast<int>(stack.size())) stack.resize(stack.size() * 2);
+
+        Accumulator &acc = stack[top];
+        acc.computed = false;
+        acc.king_moved[0] = acc.king_moved[1] = false;
+        acc.dirty.count = 0;
+
+        int from = MOVE_FROM(move);
+        int to = MOVE_TO(move);
+        int type = MOVE_TYPE(move);
+        virgo::Piece mover = board.piece_on(from);
+        virgo::Player us = board.color_on(from);
+        virgo::Player them = static_cast<virgo::Player>(us ^ 1);
+
+        if (mover == virgo::KING) acc.king_moved[us] = true;
+
+        if (type == virgo::CAPTURE || type >= virgo::PC_R) {
+            acc.dirty.add(board.piece_on(to), them, to, 64);
+        } else if (type == virgo::EN_PASSANT) {
+            int captured = (us == virgo::WHITE) ? to - 8 : to + 8;
+            acc.dirty.add(virgo::PAWN, them, captured, 64);
+        }
+
+        if (type >= virgo::PQ_R) {
+            static const virgo::Piece PROMOTED[4] = {virgo::ROOK, virgo::BISHOP, virgo::QUEEN, virgo::KNIGHT};
+            acc.dirty.add(virgo::PAWN, us, from, 64);
+            acc.dirty.add(PROMOTED[(type - virgo::PQ_R) % 4], us, 64, to);
+        } else {
+            acc.dirty.add(mover, us, from, to);
+        }
+
+        if (type == virgo::CASTLE) {
+            switch (to) {
+                case virgo::g1: acc.dirty.add(virgo::ROOK, us, virgo::h1, virgo::f1); break;
+                case virgo::c1: acc.dirty.add(virgo::ROOK, us, virgo::a1, virgo::d1); break;
+                case virgo::g8: acc.dirty.add(virgo::ROOK, us, virgo::h8, virgo::f8); break;
+                case virgo::c8: acc.dirty.add(virgo::ROOK, us, virgo::a8, virgo::d8); break;
+            }
+        }
+    }
+
+    // A null move changes no piece, the accumulator is copied from the parent
+    void push_null() {
+        if (++top == static_cast<int>(stack.size())) stack.resize(stack.size() * 2);
+
+        Accumulator &acc = stack[top];
+        acc.computed = false;
+        acc.king_moved[0] = acc.king_moved[1] = false;
+        acc.dirty.count = 0;
+    }
+
+    void pop() {
+        if (top > 0) top--;
+    }
+
+private:
+    std::vector<Accumulator> stack;
+    int top;
+};
+
+/////////////////////////////////////////////////////////////////////// SIMD KERNELS ///////////////////////////////////////////////////////////////////////////////////
+
+namespace kernels {
+
+inline void add_row(int16_t *acc, const int16_t *row) {
+#if defined(__AVX2__)
+    for (int j = 0; j < HALF_DIMENSIONS; j += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc + j));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(acc + j), _mm256_add_epi16(a, w));
+    }
+#elif defined(__SSE4_1__)
+    for (int j = 0; j < HALF_DIMENSIONS; j += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(acc + j));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j));
+        _mm_store_si128(reinterpret_cast<__m128i *>(acc + j), _mm_add_epi16(a, w));
+    }
+#else
+    for (int j = 0; j < HALF_DIMENSIONS; j++) acc[j] += row[j];
+#endif
+}
+
+inline void sub_row(int16_t *acc, const int16_t *row) {
+#if defined(__AVX2__)
+    for (int j = 0; j < HALF_DIMENSIONS; j += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc + j));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(acc + j), _mm256_sub_epi16(a, w));
+    }
+#elif defined(__SSE4_1__)
+    for (int j = 0; j < HALF_DIMENSIONS; j += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(acc + j));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j));
+        _mm_store_si128(reinterpret_cast<__m128i *>(acc + j), _mm_sub_epi16(a, w));
+    }
+#else
+    for (int j = 0; j < HALF_DIMENSIONS; j++) acc[j] -= row[j];
+#endif
+}
+
+// Clipped ReLU of one accumulator half into int8 [0, 127]
+inline void clamp_half(const int16_t *acc, int8_t *out) {
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    for (int j = 0; j < HALF_DIMENSIONS; j += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc + j));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(acc + j + 16));
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), packed);
+    }
+#elif defined(__SSE4_1__)
+    const __m128i zero = _mm_setzero_si128();
+    for (int j = 0; j < HALF_DIMENSIONS; j += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(acc + j));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i *>(acc + j + 8));
+        __m128i packed = _mm_max_epi8(_mm_packs_epi16(a, b), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), packed);
+    }
+#else
+    for (int j = 0; j < HALF_DIMENSIONS; j++) {
+        out[j] = static_cast<int8_t>(std::max<int>(0, std::min<int>(127, acc[j])));
+    }
+#endif
+}
+
+// Dot product of non-negative int8 inputs with int8 weights, n a multiple of 32
+inline int32_t dot(const int8_t *input, const int8_t *weights, int n) {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(in, w), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) sum += input[i] * weights[i];
+    return sum;
+#endif
+}
+
+}  // namespace kernels
+
+/////////////////////////////////////////////////////////////////////// NETWORK ////////////////////////////////////////////////////////////////////////////////////////
+
+class Network {
+public:
+    bool load(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        uint32_t version = read_u32(in);
+        read_u32(in); // network hash
+        uint32_t description_size = read_u32(in);
+        in.ignore(description_size);
+        if (!in || version != FILE_VERSION) return false;
+
+        read_u32(in); // feature transformer hash
+        ft_biases.resize(HALF_DIMENSIONS);
+        ft_weights.resize(static_cast<size_t>(INPUT_DIMENSIONS) * HALF_DIMENSIONS);
+        read_array(in, ft_biases);
+        read_array(in, ft_weights);
+
+        read_u32(in); // layers hash
+        read_array(in, h1_biases);
+        read_array(in, h1_weights);
+        read_array(in, h2_biases);
+        read_array(in, h2_weights);
+        in.read(reinterpret_cast<char *>(&out_bias), sizeof(out_bias));
+        read_array(in, out_weights);
+
+        // the whole file must have been consumed
+        if (!in || in.peek() != std::char_traits<char>::eof()) {
+            loaded = false;
+            return false;
+        }
+        loaded = true;
+        return true;
+    }
+
+    bool is_loaded() const { return loaded; }
+
+    // Evaluation in centipawns from the side to move's point of view
+    int evaluate(virgo::Chessboard &board, AccumulatorStack &stack) {
+        Accumulator &acc = stack.current();
+        if (!acc.computed) update(board, stack);
+
+        virgo::Player us = board.get_next_to_move();
+
+        alignas(64) int8_t transformed[2 * HALF_DIMENSIONS];
+        kernels::clamp_half(acc.values[us], transformed);
+        kernels::clamp_half(acc.values[us ^ 1], transformed + HALF_DIMENSIONS);
+
+        alignas(64) int8_t hidden1[HIDDEN1];
+        for (int i = 0; i < HIDDEN1; i++) {
+            int32_t sum = h1_biases[i] + kernels::dot(transformed, &h1_weights[i * 2 * HALF_DIMENSIONS], 2 * HALF_DIMENSIONS);
+            hidden1[i] = static_cast<int8_t>(std::max(0, std::min(127, sum >> WEIGHT_SCALE_BITS)));
+        }
+
+        alignas(64) int8_t hidden2[HIDDEN2];
+        for (int i = 0; i < HIDDEN2; i++) {
+            int32_t sum = h2_biases[i] + kernels::dot(hidden1, &h2_weights[i * HIDDEN1], HIDDEN1);
+            hidden2[i] = static_cast<int8_t>(std::max(0, std::min(127, sum >> WEIGHT_SCALE_BITS)));
+        }
+
+        int32_t output = out_bias + kernels::dot(hidden2, out_weights, HIDDEN2);
+        return (output / OUTPUT_SCALE) * 100 / PAWN_VALUE;
+    }
+
+private:
+    // Feature index of a non-king piece from one side's perspective; black
+    // sees the board rotated by 180 degrees
+    static int feature_index(virgo::Player perspective, int king_square, virgo::Piece piece, virgo::Player color, int square) {
+        // Feature order: pawn, knight, bishop, rook, queen; own piece then enemy piece
+        static const int PIECE_ORDER[6] = {
+            0, // PAWN
+            3, // ROOK
+            1, // KNIGHT
+            2, // BISHOP
+            -1, // KING
+            4  // QUEEN
+        };
+        int orient = (perspective == virgo::WHITE) ? 0 : 0x3f;
+        int base = 1 + (2 * PIECE_ORDER[piece] + (color == perspective ? 0 : 1)) * 64;
+        return (square ^ orient) + base + PS_END * (king_square ^ orient);
+    }
+
+    const int16_t *row(int index) const {
+        return &ft_weights[static_cast<size_t>(index) * HALF_DIMENSIONS];
+    }
+
+    void refresh(virgo::Chessboard &board, Accumulator &acc, virgo::Player perspective) {
+        int16_t *values = acc.values[perspective];
+        std::memcpy(values, ft_biases.data(), sizeof(acc.values[perspective]));
+
+        int king_square = (perspective == virgo::WHITE) ? board.king_square<virgo::WHITE>() : board.king_square<virgo::BLACK>();
+        for (int square = 0; square < 64; square++) {
+            virgo::Piece piece = board.piece_on(square);
+            if (piece == virgo::EMPTY || piece == virgo::KING) continue;
+            kernels::add_row(values, row(feature_index(perspective, king_square, piece, board.color_on(square), square)));
+        }
+    }
+
+    void update(virgo::Chessboard &board, AccumulatorStack &stack) {
+        Accumulator &acc = stack.current();
+        Accumulator *prev = stack.previous();
+
+        for (int p = 0; p < 2; p++) {
+            virgo::Player perspective = static_cast<virgo::Player>(p);
+            if (!prev || !prev->computed || acc.king_moved[p]) {
+                refresh(board, acc, perspective);
+                continue;
+            }
+
+            int king_square = (perspective == virgo::WHITE) ? board.king_square<virgo::WHITE>() : board.king_square<virgo::BLACK>();
+            int16_t *values = acc.values[p];
+            std::memcpy(values, prev->values[p], sizeof(acc.values[p]));
+
+            const DirtyPiece &dirty = acc.dirty;
+            for (int i = 0; i < dirty.count; i++) {
+                if (dirty.piece[i] == virgo::KING) continue;
+                if (dirty.from[i] != 64) {
+                    kernels::sub_row(values, row(feature_index(perspective, king_square, dirty.piece[i], dirty.color[i], dirty.from[i])));
+                }
+                if (dirty.to[i] != 64) {
+                    kernels::add_row(values, row(feature_index(perspective, king_square, dirty.piece[i], dirty.color[i], dirty.to[i])));
+                }
+            }
+        }
+        acc.computed = true;
+    }
+
+    static uint32_t read_u32(std::ifstream &in) {
+        uint8_t bytes[4] = {};
+        in.read(reinterpret_cast<char *>(bytes), 4);
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    // The format is little-endian, like every target we build for
+    template <typename T>
+    static void read_array(std::ifstream &in, std::vector<T> &values) {
+        in.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T, size_t N>
+    static void read_array(std::ifstream &in, T (&values)[N]) {
+        in.read(reinterpret_cast<char *>(values), N * sizeof(T));
+    }
+
+    bool loaded = false;
+    std::vector<int16_t> ft_biases;
+    std::vector<int16_t> ft_weights;
+    int32_t h1_biases[HIDDEN1];
+    int8_t h1_weights[HIDDEN1 * 2 * HALF_DIMENSIONS];
+    int32_t h2_biases[HIDDEN2];
+    int8_t h2_weights[HIDDEN2 * HIDDEN1];
+    int32_t out_bias;
+    int8_t out_weights[HIDDEN2];
+};
+
+// A/B switch between the network and the classic handcrafted evaluation
+inline Network network;
+inline bool enabled = false;
+
+inline bool load(const std::string &path) {
+    enabled = network.load(path);
+    return enabled;
+}
+
+inline void set_enabled(bool on) {
+    enabled = on && network.is_loaded();
+}
+
+}  // namespace nnue
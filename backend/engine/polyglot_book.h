@@ -0,0 +1,187 @@
+// polyglot_book.h
+#pragma once
+#include "virgo/virgo.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace polyglot {
+
+// Layout of the Random64 array from the Polyglot book format specification
+constexpr int RANDOM_COUNT = 781;
+constexpr int RANDOM_CASTLE = 768;
+constexpr int RANDOM_ENPASSANT = 772;
+constexpr int RANDOM_TURN = 780;
+
+// Each book entry is 16 big-endian bytes: key(8) move(2) weight(2) learn(4)
+constexpr size_t ENTRY_SIZE = 16;
+
+struct BookMove {
+    uint16_t move;   // virgo encoded move
+    uint16_t weight;
+};
+
+class Book {
+public:
+    // The 781 Random64 values defined by the Polyglot format
+    void set_random_table(const std::vector<uint64_t> &values) {
+        if (values.size() != RANDOM_COUNT) return;
+        std::memcpy(random64, values.data(), sizeof(random64));
+        has_random = true;
+    }
+
+    bool has_random_table() const { return has_random; }
+
+    bool open(const std::string &path) {
+        if (!file.open(path)) return false;
+        if (file.size() % ENTRY_SIZE != 0) {
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() { file.close(); }
+
+    bool is_open() const { return has_random && file.is_open(); }
+
+    size_t entry_count() const { return file.size() / ENTRY_SIZE; }
+
+    // Polyglot zobrist key of a position
+    uint64_t key(virgo::Chessboard &board) const {
+        // Polyglot kinds: black pawn 0, white pawn 1, black knight 2, ... white king 11
+        static const int KIND[6] = {
+            0, // PAWN
+            3, // ROOK
+            1, // KNIGHT
+            2, // BISHOP
+            5, // KING
+            4  // QUEEN
+        };
+
+        uint64_t hash = 0;
+        for (int square = 0; square < 64; square++) {
+            virgo::Piece piece = board.piece_on(square);
+            if (piece == virgo::EMPTY) continue;
+            int kind = KIND[piece] * 2 + (board.color_on(square) == virgo::WHITE ? 1 : 0);
+            hash ^= random64[64 * kind + square];
+        }
+
+        if (board.can_castle_king_side<virgo::WHITE>()) hash ^= random64[RANDOM_CASTLE + 0];
+        if (board.can_castle_queen_side<virgo::WHITE>()) hash ^= random64[RANDOM_CASTLE + 1];
+        if (board.can_castle_king_side<virgo::BLACK>()) hash ^= random64[RANDOM_CASTLE + 2];
+        if (board.can_castle_queen_side<virgo::BLACK>()) hash ^= random64[RANDOM_CASTLE + 3];
+
+        // The en-passant file only counts when a pawn could actually capture there
+        unsigned int ep = board.get_enpassant();
+        if (ep != virgo::INVALID) {
+            virgo::Player us = board.get_next_to_move();
+            int file = ep & 7;
+            int behind = (us == virgo::WHITE) ? static_cast<int>(ep) - 8 : static_cast<int>(ep) + 8;
+            bool capturable = false;
+            if (file > 0) {
+                capturable |= board.piece_on(behind - 1) == virgo::PAWN && board.color_on(behind - 1) == us;
+            }
+            if (file < 7) {
+                capturable |= board.piece_on(behind + 1) == virgo::PAWN && board.color_on(behind + 1) == us;
+            }
+            if (capturable) hash ^= random64[RANDOM_ENPASSANT + file];
+        }
+
+        if (board.get_next_to_move() == virgo::WHITE) hash ^= random64[RANDOM_TURN];
+
+        return hash;
+    }
+
+    // Every book move for the position, translated to the matching legal move.
+    // Entries are read straight from the mapped file, nothing is copied in.
+    std::vector<BookMove> probe(virgo::Chessboard &board, const std::vector<uint16_t> &legal_moves) const {
+        std::vector<BookMove> result;
+        if (!is_open()) return result;
+
+        uint64_t target = key(board);
+        const uint8_t *base = file.data();
+
+        size_t lo = 0, hi = entry_count();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (mapped_file::read_be64(base + mid * ENTRY_SIZE) < target) lo = mid + 1;
+            else hi = mid;
+        }
+
+        for (size_t i = lo; i < entry_count(); i++) {
+            const uint8_t *entry = base + i * ENTRY_SIZE;
+            if (mapped_file::read_be64(entry) != target) break;
+
+            uint16_t move = decode_move(board, mapped_file::read_be16(entry + 8), legal_moves);
+            uint16_t weight = mapped_file::read_be16(entry + 10);
+            if (move != 0 && weight > 0) {
+                result.push_back({move, weight});
+            }
+        }
+        return result;
+    }
+
+    // Picks a book move; weighted picks are proportional to the entry weights,
+    // otherwise the heaviest entry wins. Returns 0 when out of book.
+    uint16_t pick(virgo::Chessboard &board, const std::vector<uint16_t> &legal_moves,
+                  bool weighted, std::mt19937_64 &rng) const {
+        auto moves = probe(board, legal_moves);
+        if (moves.empty()) return 0;
+
+        if (!weighted) {
+            BookMove best = moves[0];
+            for (const auto &m : moves) {
+                if (m.weight > best.weight) best = m;
+            }
+            return best.move;
+        }
+
+        uint32_t total = 0;
+        for (const auto &m : moves) total += m.weight;
+
+        uint32_t roll = std::uniform_int_distribution<uint32_t>(0, total - 1)(rng);
+        for (const auto &m : moves) {
+            if (roll < m.weight) return m.move;
+            roll -= m.weight;
+        }
+        return moves.back().move;
+    }
+
+private:
+    // Polyglot moves: to(6) from(6) promotion(3), castling written as king takes rook
+    static uint16_t decode_move(virgo::Chessboard &board, uint16_t raw, const std::vector<uint16_t> &legal_moves) {
+        // Polyglot promotion 1..4 (n, b, r, q) to the virgo order (r, b, q, n)
+        static const int PROMOTION_INDEX[5] = {-1, 3, 1, 0, 2};
+
+        unsigned int to = raw & 0x3f;
+        unsigned int from = (raw >> 6) & 0x3f;
+        int promotion = (raw >> 12) & 0x7;
+
+        if (board.piece_on(from) == virgo::KING && board.piece_on(to) == virgo::ROOK &&
+            board.color_on(to) == board.color_on(from)) {
+            to = (to > from) ? from + 2 : from - 2;
+        }
+
+        for (uint16_t move : legal_moves) {
+            if (MOVE_FROM(move) != from || MOVE_TO(move) != to) continue;
+
+            int type = MOVE_TYPE(move);
+            bool is_promotion = type >= virgo::PQ_R && type <= virgo::PC_N;
+            if (!is_promotion && promotion == 0) return move;
+            if (is_promotion && promotion > 0 && promotion <= 4 &&
+                (type - virgo::PQ_R) % 4 == PROMOTION_INDEX[promotion]) {
+                return move;
+            }
+        }
+        return 0;
+    }
+
+    mapped_file::MappedFile file;
+    uint64_t random64[RANDOM_COUNT] = {};
+    bool has_random = false;
+};
+
+}  // namespace polyglot
@@ -0,0 +1,126 @@
+// result_cache.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace result_cache {
+
+// A finished root search. time_ms is how long it actually ran, for
+// information only: lookups match on depth and nodes.
+struct Result {
+    uint16_t best_move;
+    int score;
+    int depth;
+    uint64_t nodes;
+    int time_ms;
+    std::vector<uint16_t> pv;
+};
+
+// Results of whole searches by position key, shared by every request. The
+// keys are split over shards, each an LRU list under its own lock, so
+// concurrent lookups rarely wait on each other.
+class Cache {
+public:
+    static constexpr size_t SHARDS = 16;
+    static constexpr size_t DEFAULT_ENTRIES = 65536;
+
+    Cache() { resize(DEFAULT_ENTRIES); }
+
+    // Holds at most about entries results, dropping the least recently used
+    void resize(size_t entries) {
+        size_t per_shard = (entries + SHARDS - 1) / SHARDS;
+        for (Shard &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.capacity = per_shard;
+            shard.trim();
+        }
+    }
+
+    void clear() {
+        for (Shard &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.order.clear();
+            shard.index.clear();
+        }
+    }
+
+    // Copies the result for key and marks it recently used
+    bool lookup(uint64_t key, Result &result) {
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return false;
+        shard.order.splice(shard.order.begin(), shard.order, it->second);
+        result = it->second->second;
+        return true;
+    }
+
+    // Keeps whichever of the new and the cached result went deeper
+    void store(uint64_t key, const Result &result) {
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.capacity == 0) return;
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Result &cached = it->second->second;
+            if (result.depth > cached.depth ||
+                (result.depth == cached.depth && result.nodes >= cached.nodes)) {
+                cached = result;
+            }
+            shard.order.splice(shard.order.begin(), shard.order, it->second);
+            return;
+        }
+
+        shard.order.emplace_front(key, result);
+        shard.index[key] = shard.order.begin();
+        shard.trim();
+    }
+
+    size_t entries() {
+        size_t count = 0;
+        for (Shard &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.index.size();
+        }
+        return count;
+    }
+
+    size_t capacity() const { return shards[0].capacity * SHARDS; }
+
+    // Counted by the search: answered from the cache, seeded the root
+    // ordering only, or nothing cached
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> seeded{0};
+    std::atomic<uint64_t> misses{0};
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        size_t capacity = 0;
+        std::list<std::pair<uint64_t, Result>> order; // most recently used first
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Result>>::iterator> index;
+
+        void trim() {
+            while (index.size() > capacity) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+        }
+    };
+
+    // Zobrist keys index the TT with their low bits, take the shard from the top
+    Shard &shard_of(uint64_t key) { return shards[key >> 60]; }
+
+    static_assert(SHARDS == 16, "shard_of takes the top four bits of the key");
+
+    Shard shards[SHARDS];
+};
+
+}  // namespace result_cache
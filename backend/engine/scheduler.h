@@ -0,0 +1,210 @@
+// scheduler.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scheduler {
+
+// Runs searches on a fixed pool of worker threads, earliest deadline first.
+// Each request brings its deadline and its time budget. When the queue is
+// longer than the pool, a search gets a share of its budget that shrinks with
+// the backlog, and one that can no longer finish by its deadline, or arrives
+// at a full queue or while no pool is running, is shed: it runs its cheap
+// fallback instead. Exact searches, whose move must not depend on the load,
+// are never shrunk or shed: they queue past a full queue, and search on the
+// caller's thread while no pool is running.
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MIN_BUDGET_MS = 10;    // less than this is not worth a search
+    static constexpr int RESPONSE_MARGIN_MS = 5; // left for converting and sending the reply
+    static constexpr size_t QUEUE_PER_WORKER = 8;
+
+    // What the pool has done since it started
+    struct Stats {
+        size_t workers;
+        size_t queued;
+        size_t max_queue;
+        uint64_t completed;
+        uint64_t shed;
+        uint64_t shrunk; // searched with less than the requested budget
+        uint64_t late;   // finished after their deadline
+        uint64_t wait_ms;
+        uint64_t search_ms;
+    };
+
+    ~Scheduler() { stop(); }
+
+    // threads workers, 0 for one per core; the queue holds QUEUE_PER_WORKER
+    // searches per worker, or max_queue if it is not 0
+    void start(size_t threads, size_t max_queue = 0) {
+        std::lock_guard<std::mutex> control_lock(control);
+        halt();
+        std::lock_guard<std::mutex> lock(mutex);
+        spawn(threads, max_queue);
+    }
+
+    // Lets the workers finish the queue, then joins them
+    void stop() {
+        std::lock_guard<std::mutex> control_lock(control);
+        halt();
+    }
+
+    // Runs search(budget_ms) on a worker, or fallback() if the request is
+    // shed, and waits for it. Returns false when it was shed. Exceptions
+    // thrown by either are rethrown here.
+    bool run(Clock::time_point deadline, int time_ms, bool exact, const std::function<void(int)> &search,
+             const std::function<void()> &fallback) {
+        Job job{deadline, time_ms, exact, Clock::now(), sequence++, &search, &fallback, {}, false};
+        std::future<void> done = job.done.get_future();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopping && exact) {
+                lock.unlock();
+                search(time_ms);
+                return true;
+            }
+            if (stopping || (!exact && queue.size() >= queue_limit)) {
+                lock.unlock();
+                shed_count++;
+                fallback();
+                return false;
+            }
+            queue.push_back(&job);
+            std::push_heap(queue.begin(), queue.end(), later);
+        }
+        ready.notify_one();
+        done.get();
+        return !job.shed;
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {pool_size, queue.size(), queue_limit, completed.load(), shed_count.load(),
+                shrunk.load(), late.load(), wait_ms.load(), search_ms.load()};
+    }
+
+private:
+    struct Job {
+        Clock::time_point deadline;
+        int time_ms;
+        bool exact; // never shrunk or shed
+        Clock::time_point queued_at;
+        uint64_t order;
+        const std::function<void(int)> *search;
+        const std::function<void()> *fallback;
+        std::promise<void> done;
+        bool shed;
+    };
+
+    // Heap order: the earliest deadline on top, first come first on a tie
+    static bool later(const Job *a, const Job *b) {
+        return a->deadline != b->deadline ? a->deadline > b->deadline : a->order > b->order;
+    }
+
+    // Called with control held: from here on run() sheds, and the workers
+    // drain what is already queued
+    void halt() {
+        std::vector<std::thread> joining;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            joining.swap(workers);
+        }
+        ready.notify_all();
+        for (auto &worker : joining) worker.join();
+        std::lock_guard<std::mutex> lock(mutex);
+        pool_size = 0;
+    }
+
+    // Called with control and mutex held, after halt()
+    void spawn(size_t threads, size_t max_queue) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        stopping = false;
+        pool_size = threads;
+        queue_limit = max_queue ? max_queue : threads * QUEUE_PER_WORKER;
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    void work() {
+        while (true) {
+            Job *job;
+            size_t backlog, pool;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                std::pop_heap(queue.begin(), queue.end(), later);
+                job = queue.back();
+                queue.pop_back();
+                backlog = queue.size();
+                pool = pool_size;
+            }
+
+            auto now = Clock::now();
+            wait_ms += std::chrono::duration_cast<std::chrono::milliseconds>(now - job->queued_at).count();
+            int budget = budget_for(*job, now, backlog, pool);
+            try {
+                if (budget < MIN_BUDGET_MS && !job->exact) {
+                    job->shed = true;
+                    shed_count++;
+                    (*job->fallback)();
+                } else {
+                    if (budget < job->time_ms) shrunk++;
+                    (*job->search)(budget);
+                    completed++;
+                    auto finished = Clock::now();
+                    search_ms += std::chrono::duration_cast<std::chrono::milliseconds>(finished - now).count();
+                    if (finished > job->deadline) late++;
+                }
+                job->done.set_value();
+            } catch (...) {
+                job->done.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    // What is left until the deadline, split with the searches queued behind
+    // this one once there are more of them than workers; all of time_ms for
+    // an exact search
+    static int budget_for(const Job &job, Clock::time_point now, size_t backlog, size_t pool) {
+        if (job.exact) return job.time_ms;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline - now).count() - RESPONSE_MARGIN_MS;
+        long long budget = std::min<long long>(job.time_ms, left);
+        if (backlog > pool) {
+            budget = budget * static_cast<long long>(pool) / static_cast<long long>(backlog);
+        }
+        return static_cast<int>(std::max<long long>(budget, 0));
+    }
+
+    std::mutex control; // serializes start() and stop()
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::thread> workers;
+    std::vector<Job *> queue; // heap ordered by later()
+    size_t pool_size = 0;
+    size_t queue_limit = 0;
+    bool stopping = true; // until start()
+    std::atomic<uint64_t> sequence{0};
+
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> shed_count{0};
+    std::atomic<uint64_t> shrunk{0};
+    std::atomic<uint64_t> late{0};
+    std::atomic<uint64_t> wait_ms{0};
+    std::atomic<uint64_t> search_ms{0};
+};
+
+}  // namespace scheduler
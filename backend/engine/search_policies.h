@@ -0,0 +1,161 @@
+// search_policies.h
+#pragma once
+#include "board_adapter.h"
+#include "move_ordering.h"
+#include "search_stack.h"
+#include "transposition_table.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Compile-time building blocks of an engine variant. The search is a template
+// over a Variant, so each variant is compiled with its own choices inlined
+// and the ones it leaves out cost nothing in the hot loop.
+namespace policy {
+
+// Evaluation
+
+// NNUE when weights are loaded, the classic evaluation otherwise, both cached
+struct DefaultEval {
+    static int evaluate(board_adapter::Position &pos) { return pos.evaluate(); }
+};
+
+// Always the hand-written evaluation, uncached
+struct ClassicEval {
+    static int evaluate(board_adapter::Position &pos) { return pos.evaluate_classic(); }
+};
+
+// Pruning near the leaves, each one still bounded by the runtime search options
+
+struct FullPruning {
+    static constexpr bool REVERSE_FUTILITY = true;
+    static constexpr bool RAZORING = true;
+    static constexpr bool FUTILITY = true;
+    static constexpr bool LATE_MOVE_PRUNING = true;
+    static constexpr bool NULL_MOVE = true;
+    static constexpr bool LATE_MOVE_REDUCTIONS = true;
+    static constexpr bool DELTA = true; // in quiescence
+};
+
+// Plain PVS: every move searched to full depth
+struct NoPruning {
+    static constexpr bool REVERSE_FUTILITY = false;
+    static constexpr bool RAZORING = false;
+    static constexpr bool FUTILITY = false;
+    static constexpr bool LATE_MOVE_PRUNING = false;
+    static constexpr bool NULL_MOVE = false;
+    static constexpr bool LATE_MOVE_REDUCTIONS = false;
+    static constexpr bool DELTA = false;
+};
+
+// Quiet move ordering. Both orderings put the TT move first and captures by
+// SEE and MVV/LVA; they differ in what the quiet moves get.
+
+// Killers, then the counter move, then the history tables
+struct HistoryOrdering {
+    static uint16_t counter_move(const search::SearchStack *ss) {
+        return move_ordering::tables.counter_move(ss);
+    }
+
+    static int quiet_score(const search::SearchStack *ss, uint16_t counter, virgo::Player us, int piece, uint16_t move) {
+        if (move == ss->killers[0]) return 900;
+        if (move == ss->killers[1]) return 800;
+        if (move == counter) return 700;
+        return move_ordering::tables.quiet_score(ss, us, piece, move) / 100;
+    }
+
+    static void update_quiet(search::SearchStack *ss, int depth, virgo::Player us, int piece, uint16_t move,
+                             const uint16_t *tried, const int *tried_pieces, int tried_count) {
+        move_ordering::tables.update_quiet(ss, depth, us, piece, move, tried, tried_pieces, tried_count);
+    }
+};
+
+// Quiet moves in generation order, nothing learned during the search
+struct CaptureOrdering {
+    static uint16_t counter_move(const search::SearchStack *) { return 0; }
+    static int quiet_score(const search::SearchStack *, uint16_t, virgo::Player, int, uint16_t) { return 0; }
+    static void update_quiet(search::SearchStack *, int, virgo::Player, int, uint16_t, const uint16_t *, const int *, int) {}
+};
+
+// Every variant's own table, so resizing and clearing the hash reach them
+// all. A table created later starts at the size last set.
+class OwnTables {
+public:
+    static OwnTables &instance() {
+        static OwnTables registry;
+        return registry;
+    }
+
+    tt::Table &create() {
+        std::lock_guard<std::mutex> lock(mutex);
+        tables.push_back(std::make_unique<tt::Table>(mb));
+        return *tables.back();
+    }
+
+    bool resize(size_t size_mb) {
+        std::lock_guard<std::mutex> lock(mutex);
+        mb = size_mb;
+        bool ok = true;
+        for (auto &table : tables) ok = table->resize(mb) && ok;
+        return ok;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &table : tables) table->clear();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<tt::Table>> tables;
+    size_t mb = tt::Table::DEFAULT_MB;
+};
+
+// Transposition table of its own, so a variant's entries never mix with
+// another's. Owner only makes the table distinct per variant.
+template <typename Owner> struct OwnTable {
+    static tt::Table &table() {
+        static tt::Table &own = OwnTables::instance().create();
+        return own;
+    }
+
+    static bool probe(uint64_t key, tt::Entry &entry) { return table().probe(key, entry); }
+    static void store(uint64_t key, const tt::Entry &entry) { table().store(key, entry); }
+    static void new_search() { table().new_search(); }
+};
+
+// The thread's own small table, emptied at the start of every search, so
+// what the search finds depends only on its position and limits
+struct PrivateTable {
+    static constexpr size_t MB = 2;
+
+    static tt::Table &table() {
+        thread_local tt::Table own(MB);
+        return own;
+    }
+
+    static bool probe(uint64_t key, tt::Entry &entry) { return table().probe(key, entry); }
+    static void store(uint64_t key, const tt::Entry &entry) { table().store(key, entry); }
+    static void new_search() { table().clear(); }
+};
+
+template <typename EvalPolicy, typename PruningPolicy, typename OrderingPolicy, typename TablePolicy>
+struct Variant {
+    using Eval = EvalPolicy;
+    using Pruning = PruningPolicy;
+    using Ordering = OrderingPolicy;
+    using Table = TablePolicy;
+    static constexpr bool ISOLATED = false; // starts from empty tables and history
+};
+
+// A variant searching on a private table with cleared history and no help
+// from other requests' results, so the same request always plays the same
+// move whatever ran before it
+template <typename V>
+struct Isolated : Variant<typename V::Eval, typename V::Pruning, typename V::Ordering, PrivateTable> {
+    static constexpr uint64_t SALT = V::SALT;
+    static constexpr bool ISOLATED = true;
+};
+
+}  // namespace policy
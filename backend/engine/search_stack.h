@@ -0,0 +1,45 @@
+// search_stack.h
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace search {
+
+constexpr int MAX_PLY = 128;
+
+// Static eval of a node in check, where it is not computed
+constexpr int NO_EVAL = -1000001;
+
+// What the search knows about one ply of the current line
+struct SearchStack {
+    int ply;
+    int static_eval;
+    uint16_t current_move;   // move being searched from this node, 0 for a null move
+    int moved_piece;         // piece of current_move as color * 6 + type, -1 for a null move
+    uint16_t killers[2];
+    int pv_length;
+    uint16_t pv[MAX_PLY + 1];
+};
+
+// Preallocated stack for one search thread. A few entries sit before the
+// root so the search can always look two plies back without checks.
+struct SearchStackArray {
+    static constexpr int OFFSET = 2;
+
+    SearchStack entries[MAX_PLY + OFFSET + 1];
+
+    SearchStack *root() { return entries + OFFSET; }
+
+    void clear() {
+        std::memset(entries, 0, sizeof(entries));
+        for (int i = 0; i < MAX_PLY + OFFSET + 1; i++) {
+            entries[i].ply = i - OFFSET;
+            entries[i].static_eval = NO_EVAL;
+            entries[i].moved_piece = -1;
+        }
+    }
+};
+
+inline thread_local SearchStackArray search_stack;
+
+}  // namespace search
@@ -0,0 +1,218 @@
+// tablebase.h
+#pragma once
+#include <pybind11/pybind11.h>
+#include "board_adapter.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace tablebase {
+
+namespace py = pybind11;
+
+// Scores for tablebase wins sit between heuristic evals and mate scores
+constexpr int TB_WIN_SCORE = 20000;
+
+enum WDL {
+    LOSS = -2,
+    BLESSED_LOSS = -1,
+    DRAW = 0,
+    CURSED_WIN = 1,
+    WIN = 2
+};
+
+// Syzygy WDL/DTZ prober. The table files are memory-mapped by python-chess's
+// syzygy reader; probes take the GIL and build a chess.Board, tens of
+// microseconds each, so they are only made on request threads, which hold the
+// GIL anyway: the root move of a position in range, and the positions a few
+// captures or pawn moves ahead of the root. Their WDL results are cached by
+// position hash, and the search workers only read that cache.
+class Tablebase {
+public:
+    // path may list several directories separated by ':' (';' on Windows)
+    bool open(const std::string &path, int piece_limit, int plies_ahead) {
+        py::gil_scoped_acquire acquire;
+        close();
+
+#ifdef _WIN32
+        const char separator = ';';
+#else
+        const char separator = ':';
+#endif
+        std::vector<std::string> directories;
+        size_t start = 0;
+        while (start <= path.size()) {
+            size_t end = path.find(separator, start);
+            if (end == std::string::npos) end = path.size();
+            if (end > start) directories.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+        if (directories.empty()) return false;
+
+        try {
+            py::object syzygy = py::module_::import("chess.syzygy");
+            tables = syzygy.attr("open_tablebase")(directories[0]);
+            for (size_t i = 1; i < directories.size(); i++) {
+                tables.attr("add_directory")(directories[i]);
+            }
+            chess_board = py::module_::import("chess").attr("Board");
+        } catch (const std::exception &) {
+            tables = py::object();
+            return false;
+        }
+
+        max_pieces = piece_limit;
+        probe_depth = plies_ahead;
+        return true;
+    }
+
+    void close() {
+        py::gil_scoped_acquire acquire;
+        if (tables) tables.attr("close")();
+        tables = py::object();
+        chess_board = py::object();
+        for (auto &slot : wdl_cache) slot.data.store(0, std::memory_order_relaxed);
+    }
+
+    bool is_open() const { return static_cast<bool>(tables); }
+
+    void set_max_pieces(int piece_limit) { max_pieces = piece_limit; }
+    int get_max_pieces() const { return max_pieces; }
+    int get_probe_depth() const { return probe_depth; }
+
+    // Whether a position is small enough to be looked up
+    bool in_range(board_adapter::Position &pos) {
+        return is_open() && !pos.has_castling_rights() && pos.piece_count() <= max_pieces;
+    }
+
+    // WDL of a position probed earlier, without the GIL; what the search uses
+    bool cached_wdl(board_adapter::Position &pos, int &wdl) const {
+        uint64_t key = pos.board.get_key();
+        const CacheSlot &slot = wdl_cache[key & (WDL_CACHE_SIZE - 1)];
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && data != 0) {
+            wdl = static_cast<int>(data) - CACHED;
+            return true;
+        }
+        return false;
+    }
+
+    // WDL from the side to move's point of view; false if the table is missing
+    bool probe_wdl(board_adapter::Position &pos, int &wdl) {
+        if (cached_wdl(pos, wdl)) return true;
+
+        py::gil_scoped_acquire acquire;
+        py::object result = tables.attr("get_wdl")(chess_board(pos.to_fen()), py::none());
+        if (result.is_none()) return false;
+
+        wdl = result.cast<int>();
+        uint64_t key = pos.board.get_key();
+        uint64_t data = static_cast<uint64_t>(wdl + CACHED);
+        CacheSlot &slot = wdl_cache[key & (WDL_CACHE_SIZE - 1)];
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Probes the positions in range that up to probe_depth captures or pawn
+    // moves lead to from pos, so the search finds them cached. Stops after
+    // MAX_PROBES_AHEAD probes to bound the request's latency.
+    void probe_ahead(board_adapter::Position &pos) {
+        int budget = MAX_PROBES_AHEAD;
+        probe_ahead(pos, probe_depth, budget);
+    }
+
+    // Distance to zeroing the fifty move counter, signed like the WDL value
+    bool probe_dtz(board_adapter::Position &pos, int &dtz) {
+        py::gil_scoped_acquire acquire;
+        py::object result = tables.attr("get_dtz")(chess_board(pos.to_fen()), py::none());
+        if (result.is_none()) return false;
+
+        dtz = result.cast<int>();
+        return true;
+    }
+
+    // Search score for a WDL value at ply from the root, nearer wins scoring
+    // higher like mates; cursed wins and blessed losses are draws under the
+    // fifty move rule
+    static int wdl_to_score(int wdl, int ply) {
+        if (wdl == WIN) return TB_WIN_SCORE - ply;
+        if (wdl == LOSS) return -TB_WIN_SCORE + ply;
+        return 0;
+    }
+
+    // Picks the root move with the best tablebase result: win > draw > loss,
+    // the fastest conversion when winning and the longest defence when losing.
+    // Returns 0 if any of the resulting positions is missing from the tables.
+    uint16_t probe_root(board_adapter::Position &pos, const std::vector<uint16_t> &moves, int &score) {
+        uint16_t best_move = 0;
+        int best_wdl = LOSS - 1;
+        int best_dtz = 0;
+
+        for (auto move : moves) {
+            pos.make_move(move);
+            int wdl, dtz;
+            bool found = probe_wdl(pos, wdl) && probe_dtz(pos, dtz);
+            pos.undo_move();
+            if (!found) return 0;
+
+            // values are from the opponent's side after our move
+            wdl = -wdl;
+            dtz = -dtz;
+
+            // a smaller signed dtz is a faster win or a slower loss
+            bool better = wdl > best_wdl || (wdl == best_wdl && wdl != DRAW && dtz < best_dtz);
+
+            if (better) {
+                best_move = move;
+                best_wdl = wdl;
+                best_dtz = dtz;
+            }
+        }
+
+        score = wdl_to_score(best_wdl, 0);
+        return best_move;
+    }
+
+private:
+    static constexpr int MAX_PROBES_AHEAD = 256;
+
+    // Each ply takes at most one piece off, so positions with more than
+    // max_pieces + plies pieces cannot reach the tables
+    void probe_ahead(board_adapter::Position &pos, int plies, int &budget) {
+        if (plies <= 0 || pos.piece_count() > max_pieces + plies) return;
+        for (auto move : pos.get_legal_moves()) {
+            if (budget <= 0) return;
+            pos.make_move(move);
+            if (pos.board.get_fifty_mv_counter() == 0) {
+                int wdl;
+                if (in_range(pos)) {
+                    budget--;
+                    probe_wdl(pos, wdl);
+                }
+                probe_ahead(pos, plies - 1, budget);
+            }
+            pos.undo_move();
+        }
+    }
+
+    // Direct-mapped, a colliding position replaces the old one. Searches on
+    // every worker share it lock-free like the TT: the key is stored xor'ed
+    // with the data, so a slot torn by a concurrent write reads as a miss.
+    static constexpr size_t WDL_CACHE_SIZE = 1 << 16;
+    static constexpr int CACHED = 3; // stored wdl is offset so that 0 means empty
+
+    struct CacheSlot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    py::object tables;
+    py::object chess_board;
+    int max_pieces = 5;
+    int probe_depth = 2;
+    std::vector<CacheSlot> wdl_cache = std::vector<CacheSlot>(WDL_CACHE_SIZE);
+};
+
+}  // namespace tablebase
@@ -1,7 +1,535 @@
-from engine_strong_cpp import get_best_move
+from engine_strong_cpp import get_best_move, load_book
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
 
-fen = "8/1kP5/8/8/8/8/5q2/7K b - - 0 1"
+import chess
+import chess.polyglot
 
-result = get_best_move(fen, time_ms=2000)
+import engine_core
+import engine_strong_cpp2
 
-print("Best move from engine:", result)
+# Each check_* function below tests one engine feature with plain asserts;
+# run this file from backend/engine once engine_core is built.
+
+
+def polyglot_move(uci):
+    move = chess.Move.from_uci(uci)
+    return move.to_square | move.from_square << 6
+
+
+# Opening book: the Polyglot spec's reference positions, each booked with one
+# move that only comes back if the engine computes the spec's key
+POLYGLOT_KEYS = [
+    ([], 0x463b96181691fc9c),
+    (["e2e4"], 0x823c9b50fd114196),
+    (["e2e4", "d7d5"], 0x0756b94461c50fb0),
+    (["e2e4", "d7d5", "e4e5"], 0x662fafb965db29d4),
+    (["e2e4", "d7d5", "e4e5", "f7f5"], 0x22a48b5a8e47ff78),
+    (["e2e4", "d7d5", "e4e5", "f7f5", "e1e2"], 0x652a607ca3f242c1),
+    (["e2e4", "d7d5", "e4e5", "f7f5", "e1e2", "e8f7"], 0x00fdd303c946bdd9),
+    (["a2a4", "b7b5", "h2h4", "b5b4", "c2c4"], 0x3c8123ea7b067637),
+    (["a2a4", "b7b5", "h2h4", "b5b4", "c2c4", "b4c3", "a1a3"], 0x5c3f9b829b279560),
+]
+
+
+def check_book():
+    entries = []
+    positions = []
+    for moves, key in POLYGLOT_KEYS:
+        board = chess.Board()
+        for uci in moves:
+            board.push_uci(uci)
+        assert chess.polyglot.zobrist_hash(board) == key
+        book_move = min(move.uci() for move in board.legal_moves)
+        entries.append(struct.pack(">QHHI", key, polyglot_move(book_move), 1, 0))
+        positions.append((board.fen(), book_move))
+
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "book.bin")
+        with open(path, "wb") as f:
+            f.write(b"".join(sorted(entries)))
+        assert load_book(path)
+        try:
+            for fen, book_move in positions:
+                assert engine_core.book_move(fen, False) == book_move, fen
+                assert [item["move"] for item in engine_core.book_moves(fen)] == [book_move]
+            result = engine_core.get_best_move_cpp(chess.STARTING_FEN, 100)
+            assert result.get("book") and result["bestmove"] == positions[0][1]
+        finally:
+            engine_core.unload_book()
+    assert engine_core.book_move(chess.STARTING_FEN, False) == ""
+
+
+# Tablebases: perfect results at the root, and a capture into the tables
+# scoring as a win one ply from the root. Needs SYZYGY_PATH with the 3-4 piece
+# tables; without it only a missing directory is checked.
+TB_WIN = 20000
+
+
+def check_tablebases():
+    assert not engine_core.load_tablebases(os.path.join(tempfile.gettempdir(), "no-such-syzygy"), 5)
+    path = os.environ.get("SYZYGY_PATH")
+    if not path:
+        return
+    assert engine_core.load_tablebases(path, 5)
+    try:
+        result = engine_core.get_best_move_cpp("8/8/8/8/8/2k5/8/4K2Q w - - 0 1", 100)
+        assert result.get("tablebase") and result["cp"] == TB_WIN
+        result = engine_core.get_best_move_cpp("8/8/8/8/8/2k5/8/4K2Q b - - 0 1", 100)
+        assert result.get("tablebase") and result["cp"] == -TB_WIN
+        result = engine_core.get_best_move_cpp("8/8/8/8/8/2k5/8/4K1N1 w - - 0 1", 100)
+        assert result.get("tablebase") and result["cp"] == 0
+
+        # MultiPV skips the root probe and searches
+        result = engine_core.get_best_move_cpp("8/8/8/8/8/2k3K1/8/r6Q w - - 0 1", 5000, False, 2, 4)
+        assert result["lines"][0]["move"] == "h1a1" and result["lines"][0]["cp"] == TB_WIN - 1
+    finally:
+        engine_core.load_tablebases("", 5)
+
+
+# NNUE: a file that is not a network is refused and the classic evaluation
+# stays; with NNUE_PATH set, the network loads and switches back off. A
+# weakened search is reproducible, so equal results mean equal evaluation.
+MIDDLEGAME = "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4"
+
+
+def reproducible_search(fen):
+    result = engine_core.get_best_move_cpp(fen, 10000, False, skill=10, seed=1)
+    return result["bestmove"], result["cp"], result["nodes"]
+
+
+def check_nnue():
+    classic = reproducible_search(MIDDLEGAME)
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "bad.nnue")
+        with open(path, "wb") as f:
+            f.write(b"\0" * 1024)
+        assert not engine_core.load_nnue(path)
+    assert reproducible_search(MIDDLEGAME) == classic
+
+    path = os.environ.get("NNUE_PATH")
+    if not path:
+        return
+    assert engine_core.load_nnue(path)
+    try:
+        move = reproducible_search(MIDDLEGAME)[0]
+        assert chess.Move.from_uci(move) in chess.Board(MIDDLEGAME).legal_moves
+    finally:
+        engine_core.set_nnue(False)
+    assert reproducible_search(MIDDLEGAME) == classic
+
+
+# Pawn structure, read through the pawn hash: the evaluation is the same for
+# a position and its colour-flipped mirror, and doubled isolated pawns cost
+EVAL_POSITIONS = [
+    chess.STARTING_FEN,
+    MIDDLEGAME,
+    "8/pp3p2/2p3p1/3P4/1P3P2/P5P1/8/4K1k1 w - - 0 1",
+    "r2q1rk1/ppp2ppp/2npbn2/2b1p3/2B1P3/2NPBN2/PPPQ1PPP/R3K2R w KQ - 6 8",
+]
+
+
+def check_pawn_structure():
+    for fen in EVAL_POSITIONS:
+        mirror = chess.Board(fen).mirror().fen()
+        assert engine_core.evaluate_cpp(fen) == engine_core.evaluate_cpp(mirror), fen
+    healthy = engine_core.evaluate_cpp("4k3/8/8/8/8/8/PPP5/4K3 w - - 0 1")
+    doubled = engine_core.evaluate_cpp("4k3/8/8/8/8/P7/P1P5/4K3 w - - 0 1")
+    assert healthy > doubled
+
+
+# Evaluation cache: a second pass over a game's positions, answered from the
+# cache, matches the first, and the side to move keeps its own entry (the
+# classic evaluation differs between the sides only by the 10cp tempo)
+def check_eval_cache():
+    board = chess.Board()
+    fens = []
+    for ply in range(60):
+        moves = sorted(board.legal_moves, key=lambda move: move.uci())
+        if not moves:
+            break
+        board.push(moves[ply * 7 % len(moves)])
+        fens.append(board.fen())
+    first = [engine_core.evaluate_cpp(fen) for fen in fens]
+    assert [engine_core.evaluate_cpp(fen) for fen in fens] == first
+
+    for fen in EVAL_POSITIONS:
+        board = chess.Board(fen)
+        board.turn = not board.turn
+        assert engine_core.evaluate_cpp(fen) + engine_core.evaluate_cpp(board.fen()) == 20, fen
+
+
+# Repetition: far behind, black draws by perpetual check, which the search
+# only sees by spotting the repeated positions
+def check_repetition():
+    result = engine_core.get_best_move_cpp("k7/ppp5/2R5/Rq6/Q7/5PPP/5P2/7K b - - 0 1", 10000, False, 1, 10)
+    assert result["bestmove"] == "b5f1" and result["cp"] == 0
+
+
+# SEE: captures of defended pawns that lose the capturing piece are not played
+def check_losing_captures():
+    result = engine_core.get_best_move_cpp("4k3/8/3p4/4p3/3Q4/8/8/4K3 w - - 0 1", 10000, False, 1, 8)
+    assert result["bestmove"] != "d4e5" and result["cp"] > 500
+    result = engine_core.get_best_move_cpp("4k3/2p5/3p4/4p3/8/8/3R4/3RK3 w - - 0 1", 10000, False, 1, 8)
+    assert result["bestmove"] != "d2d6" and result["cp"] > 300
+
+
+# Null move and late move reductions: far fewer nodes than the unpruned
+# variant for the same depth, without losing a forced mate, and a short
+# timed search goes deeper than the old 8-ply cap
+MATE_IN_2 = "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 1"
+
+
+def check_pruning():
+    engine_core.clear_hash()
+    pruned = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 5)
+    unpruned = engine_core.get_best_move_unpruned(MIDDLEGAME, 60000, False, 1, 5)
+    assert pruned["depth"] == unpruned["depth"] == 5
+    assert pruned["nodes"] * 4 < unpruned["nodes"]
+
+    result = engine_core.get_best_move_cpp(MATE_IN_2, 10000, False, 1, 6)
+    assert result["bestmove"] == "d5d8" and result["mate"] == 2
+
+    engine_core.clear_result_cache()
+    assert engine_core.get_best_move_cpp(MIDDLEGAME, 500, False)["depth"] > 8
+
+
+# Leaf pruning: the options read back as set, unknown names are refused, and
+# turning futility, reverse futility, razoring and late move pruning off costs
+# nodes
+def check_leaf_pruning():
+    defaults = dict(engine_core.get_search_options())
+    assert not engine_core.set_search_option("no_such_option", 1)
+
+    engine_core.clear_hash()
+    pruned = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 6)
+    try:
+        for name in ("rfp_depth", "razor_depth", "futility_depth", "lmp_depth"):
+            assert engine_core.set_search_option(name, 0)
+            assert engine_core.get_search_options()[name] == 0
+        engine_core.clear_hash()
+        unpruned = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 6)
+    finally:
+        for name, value in defaults.items():
+            engine_core.set_search_option(name, value)
+    assert pruned["nodes"] * 2 < unpruned["nodes"]
+    assert dict(engine_core.get_search_options()) == defaults
+
+
+# Killer, counter move and history ordering: with no pruning either way, the
+# unpruned variant (history ordering) and the basic one (captures first) agree
+# on the score, and the history ordering gets there with fewer nodes
+def check_move_ordering():
+    engine_core.clear_hash()
+    history = engine_core.get_best_move_unpruned(MIDDLEGAME, 60000, False, 1, 5)
+    captures_first = engine_core.get_best_move_basic(MIDDLEGAME, 60000, False, 1, 5)
+    assert history["cp"] == captures_first["cp"]
+    assert history["nodes"] < captures_first["nodes"]
+
+
+# Aspiration windows and PVS: every iteration completes to the requested
+# depth and the principal variation is a legal line starting with the move,
+# as long as the depth when nothing ends it early
+def check_principal_variation():
+    engine_core.clear_hash()
+    engine_core.clear_result_cache()
+    result = engine_core.get_best_move_cpp(chess.STARTING_FEN, 60000, False, 1, 8)
+    assert len(result["pv"]) == 8, result["pv"]
+
+    for fen in EVAL_POSITIONS:
+        result = engine_core.get_best_move_cpp(fen, 60000, False, 1, 7)
+        assert result["depth"] >= 7 and result["pv"][0] == result["bestmove"], fen
+        board = chess.Board(fen)
+        for uci in result["pv"]:
+            move = chess.Move.from_uci(uci)
+            assert move in board.legal_moves, (fen, result["pv"])
+            board.push(move)
+
+
+# Quiescence: a one-ply search plays out the captures, winning the hanging
+# queen and seeing the recapture behind a defended knight, with or without
+# delta pruning
+def check_quiescence():
+    hanging = "4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1"
+    defended = "4k3/8/3p4/4n3/8/5N2/8/4K3 w - - 0 1"
+    assert engine_core.evaluate_cpp(hanging) < 0
+    for search in (engine_core.get_best_move_cpp, engine_core.get_best_move_unpruned):
+        result = search(hanging, 10000, False, 1, 1)
+        assert result["bestmove"] == "d2d5" and result["cp"] > 400
+        result = search(defended, 10000, False, 1, 1)
+        assert result["cp"] < 0
+
+
+# Search stack: a depth past the stack's 128 plies is clamped, and a long
+# endgame search stays within it
+def check_deep_search():
+    result = engine_core.get_best_move_cpp("8/8/4k3/8/8/4K3/4P3/8 w - - 0 1", 60000, False, 1, 500, 200000)
+    assert 10 < result["depth"] < 128 and len(result["pv"]) < 128
+    assert chess.Move.from_uci(result["bestmove"]) in chess.Board("8/8/4k3/8/8/4K3/4P3/8 w - - 0 1").legal_moves
+
+
+# MultiPV: the requested number of distinct legal lines, best first, capped
+# by the number of legal moves
+def check_multipv():
+    result = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 3, 6)
+    lines = result["lines"]
+    assert len(lines) == 3 and lines[0]["move"] == result["bestmove"]
+    assert len({line["move"] for line in lines}) == 3
+    assert [line["cp"] for line in lines] == sorted((line["cp"] for line in lines), reverse=True)
+    board = chess.Board(MIDDLEGAME)
+    assert all(chess.Move.from_uci(line["move"]) in board.legal_moves for line in lines)
+
+    result = engine_core.get_best_move_cpp("7k/8/8/8/8/8/8/K7 w - - 0 1", 60000, False, 5, 4)
+    assert len(result["lines"]) == 3
+
+
+# Mate solver: the shortest mate within the limit, none within a shorter one,
+# the same with checking moves only; and the search's mate distance
+def check_mate_solver():
+    result = engine_core.find_mate_cpp(MATE_IN_2, 2, False, 1000000)
+    assert result["complete"] and result["mate"] == 2 and result["bestmove"] == "d5d8"
+    assert list(result["pv"]) == ["d5d8", "e7d8", "e1e8"]
+    result = engine_core.find_mate_cpp(MATE_IN_2, 1, False, 1000000)
+    assert result["complete"] and result["mate"] == 0
+    result = engine_core.find_mate_cpp(MATE_IN_2, 2, True, 1000000)
+    assert result["mate"] == 2 and result["bestmove"] == "d5d8"
+
+    result = engine_core.get_best_move_cpp("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 10000, False)
+    assert result["bestmove"] == "d1d8" and result["mate"] == 1
+
+
+# Node budgets and strength levels: a node limit holds within the stop
+# check's slack and still stops at time_ms, a level searches the same
+# whatever ran before it, and lower levels search less
+def check_strength_levels():
+    result = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, nodes=20000)
+    assert result["nodes"] < 22000
+    engine_core.clear_result_cache()
+    start = time.monotonic()
+    engine_core.get_best_move_cpp(MIDDLEGAME, 30, False, 1, 40, 2000000)
+    assert time.monotonic() - start < 1
+
+    weak = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, skill=5, seed=7)
+    engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 6)
+    engine_core.get_best_move_cpp(chess.STARTING_FEN, 60000, False, 1, 6)
+    again = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, skill=5, seed=7)
+    assert (weak["bestmove"], weak["cp"], weak["nodes"]) == (again["bestmove"], again["cp"], again["nodes"])
+
+    weakest = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, skill=0, seed=7)
+    assert weakest["nodes"] < weak["nodes"]
+
+
+# History stack: make/undo through every line of the move tree leaves the
+# counts the standard perft tables give
+def check_perft():
+    assert engine_core.perft_cpp(chess.STARTING_FEN, 5) == 4865609
+    assert engine_core.perft_cpp("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6) == 11030083
+
+
+# Board layout: castling, en passant and promotions move the right pieces
+# (Kiwipete and the perft suite's promotion position)
+def check_perft_special_moves():
+    assert engine_core.perft_cpp("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4) == 4085603
+    assert engine_core.perft_cpp("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4) == 2103487
+
+
+# Attack maps: check evasions, pins and discovered checks generate exactly the
+# legal moves (the perft suite's positions 4 and 6)
+def check_perft_checks_and_pins():
+    assert engine_core.perft_cpp("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5) == 15833292
+    assert engine_core.perft_cpp("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4) == 3894594
+
+
+# Shared hash: a second process attached to the same segment leaves its
+# entries behind, and they make this process's search much cheaper
+def check_shared_hash():
+    if not os.path.isdir("/dev/shm"):
+        return
+    name = f"engine-test-{os.getpid()}"
+    assert engine_core.attach_shared_hash(name, 4)
+    try:
+        assert engine_core.hash_info()["shared"]
+        engine_core.clear_hash()
+        cold = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 7)
+        engine_core.clear_hash()
+        other_process = (
+            f"import engine_core\n"
+            f"assert engine_core.attach_shared_hash({name!r}, 4)\n"
+            f"engine_core.get_best_move_cpp({MIDDLEGAME!r}, 60000, False, 1, 7)\n"
+        )
+        subprocess.run([sys.executable, "-c", other_process], check=True,
+                       cwd=os.path.dirname(os.path.abspath(__file__)))
+        engine_core.clear_result_cache()
+        warm = engine_core.get_best_move_cpp(MIDDLEGAME, 60000, False, 1, 7)
+        assert warm["nodes"] * 4 < cold["nodes"]
+    finally:
+        engine_core.set_hash_size(16)
+        if os.path.exists(f"/dev/shm/{name}"):
+            os.remove(f"/dev/shm/{name}")
+
+
+# Snapshots: the saved entries load back, a damaged header is refused, and the
+# loaded entries answer for an emptied table
+def check_snapshot():
+    fen = EVAL_POSITIONS[3]
+    engine_core.clear_hash()
+    engine_core.clear_result_cache()
+    cold = engine_core.get_best_move_cpp(fen, 60000, False, 1, 7)
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "tt.snap")
+        saved = engine_core.save_hash_snapshot(path, 4)
+        assert saved > 0
+
+        with open(path, "rb") as f:
+            data = bytearray(f.read())
+        data[8] ^= 0xff
+        damaged = os.path.join(directory, "damaged.snap")
+        with open(damaged, "wb") as f:
+            f.write(data)
+        assert not engine_core.load_hash_snapshot(damaged)
+
+        try:
+            assert engine_core.load_hash_snapshot(path)
+            assert engine_core.hash_info()["snapshot_entries"] == saved
+            engine_core.clear_hash()
+            engine_core.clear_result_cache()
+            warm = engine_core.get_best_move_cpp(fen, 60000, False, 1, 7)
+            assert warm["nodes"] * 2 < cold["nodes"]
+        finally:
+            # a missing file unloads the snapshot, so the directory can go
+            engine_core.load_hash_snapshot(os.path.join(directory, "missing.snap"))
+    assert engine_core.hash_info()["snapshot_entries"] == 0
+
+
+# Result cache: a result answers requests it searched at least as deep, as
+# many nodes or as long for, and only seeds the ordering of longer ones
+def check_result_cache():
+    fen = EVAL_POSITIONS[2]
+    engine_core.clear_result_cache()
+    before = dict(engine_core.result_cache_info())
+    first = engine_core.get_best_move_cpp(fen, 60000, False, 1, 6)
+    assert not first.get("cached")
+
+    again = engine_core.get_best_move_cpp(fen, 60000, False, 1, 5)
+    assert again.get("cached") and again["bestmove"] == first["bestmove"] and again["depth"] == 6
+    assert engine_core.get_best_move_cpp(fen, 60000, False, nodes=first["nodes"]).get("cached")
+
+    deeper = engine_core.get_best_move_cpp(fen, 60000, False, 1, 7)
+    assert not deeper.get("cached") and deeper["depth"] == 7
+    timed = engine_core.get_best_move_cpp(fen, 300, False)
+    assert not timed.get("cached") and timed["depth"] > 7
+    assert engine_core.get_best_move_cpp(fen, 300, False).get("cached")
+
+    info = engine_core.result_cache_info()
+    assert info["hits"] - before["hits"] == 3
+    assert info["seeded"] - before["seeded"] == 2
+    assert info["misses"] - before["misses"] == 1
+
+
+# Coalescing: identical requests arriving together share the first one's
+# search and all get its result
+def check_coalescing():
+    fen = EVAL_POSITIONS[3]
+    capacity = engine_core.result_cache_info()["capacity"]
+    engine_core.set_result_cache_size(0)
+    engine_core.clear_hash()
+    joined = engine_core.coalesce_info()["joined"]
+
+    start = threading.Barrier(4)
+    results = []
+
+    def request():
+        start.wait()
+        results.append(engine_core.get_best_move_cpp(fen, 60000, False, 1, 9))
+
+    threads = [threading.Thread(target=request) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    engine_core.set_result_cache_size(capacity)
+
+    assert engine_core.coalesce_info()["joined"] > joined
+    assert len({(result["bestmove"], result["nodes"]) for result in results}) == 1
+
+
+# Load shedding: with one worker and room for one waiting search, a burst of
+# requests gets quick fallback moves instead of queueing, except weakened
+# ones, which play the move they would play alone
+def check_load_shedding():
+    fens = EVAL_POSITIONS + [MATE_IN_2, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"]
+    seeds = range(4)
+    alone = {seed: engine_core.get_best_move_cpp(MIDDLEGAME, 300, False, skill=5, seed=seed) for seed in seeds}
+    engine_core.set_search_threads(1, 1)
+    shed = engine_core.scheduler_info()["shed"]
+
+    start = threading.Barrier(len(fens) + len(seeds))
+    results = {}
+    weakened = {}
+
+    def request(fen):
+        start.wait()
+        results[fen] = engine_core.get_best_move_cpp(fen, 300, False)
+
+    def weakened_request(seed):
+        start.wait()
+        weakened[seed] = engine_core.get_best_move_cpp(MIDDLEGAME, 300, False, skill=5, seed=seed)
+
+    threads = [threading.Thread(target=request, args=(fen,)) for fen in fens]
+    threads += [threading.Thread(target=weakened_request, args=(seed,)) for seed in seeds]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    engine_core.set_search_threads(0, 0)
+
+    shed = engine_core.scheduler_info()["shed"] - shed
+    assert shed > 0
+    assert sum(1 for result in results.values() if result.get("fallback")) == shed
+    for fen, result in results.items():
+        assert chess.Move.from_uci(result["bestmove"]) in chess.Board(fen).legal_moves
+    for seed in seeds:
+        assert (weakened[seed]["bestmove"], weakened[seed]["nodes"]) == (alone[seed]["bestmove"], alone[seed]["nodes"])
+
+
+# Variants: each searches with a table of its own, which clear_hash empties
+# and set_hash_size resizes along with the main one
+def check_variants():
+    engine_core.clear_hash()
+    cold = engine_core.get_best_move_basic(MIDDLEGAME, 60000, False, 1, 5)
+    engine_core.clear_result_cache()
+    warm = engine_core.get_best_move_basic(MIDDLEGAME, 60000, False, 1, 5)
+    assert warm["nodes"] * 4 < cold["nodes"]
+    engine_core.clear_hash()
+    assert engine_core.get_best_move_basic(MIDDLEGAME, 60000, False, 1, 5)["nodes"] == cold["nodes"]
+
+    unpruned = engine_core.get_best_move_unpruned(MIDDLEGAME, 60000, False, 1, 4)
+    assert unpruned["depth"] == 4
+    board = chess.Board(MIDDLEGAME)
+    for result in (cold, unpruned):
+        assert chess.Move.from_uci(result["bestmove"]) in board.legal_moves
+    for variant in ("basic", "unpruned"):
+        assert chess.Move.from_uci(engine_strong_cpp2.get_best_move(MIDDLEGAME, 100, variant)) in board.legal_moves
+
+    assert engine_core.set_hash_size(8)
+    assert engine_core.hash_info()["mb"] == 8
+    assert chess.Move.from_uci(engine_core.get_best_move_basic(MIDDLEGAME, 100, False)["bestmove"]) in board.legal_moves
+    engine_core.set_hash_size(16)
+
+
+if __name__ == "__main__":
+    fen = "8/1kP5/8/8/8/8/5q2/7K b - - 0 1"
+
+    result = get_best_move(fen, time_ms=2000)
+
+    print("Best move from engine:", result)
+
+    for name, check in list(globals().items()):
+        if name.startswith("check_"):
+            check()
+            print(name, "ok")
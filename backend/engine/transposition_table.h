@@ -0,0 +1,311 @@
+// transposition_table.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tt {
+
+// What the search stores about a position
+struct Entry {
+    int depth;
+    int eval;
+    uint16_t best_move;
+    int node_type; // 0=exact, 1=upper bound, 2=lower bound
+};
+
+// Fixed-size lock-free transposition table. Each slot holds the entry packed
+// into one word (eval, move, depth, bound, generation) and the key xor'ed
+// with it, so a slot half-written by another thread or process reads as a
+// miss instead of a wrong entry.
+//
+// The table either lives in private memory or in a named shared-memory
+// segment that every worker process on the host attaches to.
+class Table {
+public:
+    static constexpr size_t DEFAULT_MB = 16;
+
+    Table() = default;
+    explicit Table(size_t mb) { resize(mb); }
+    Table(const Table &) = delete;
+    Table &operator=(const Table &) = delete;
+    ~Table() { release(); }
+
+    // Private table of about mb megabytes, cleared
+    bool resize(size_t mb) {
+        release();
+        size_t count = slot_count(mb);
+        size_t bytes = sizeof(Header) + count * sizeof(Slot);
+        owned = new (std::nothrow) uint8_t[bytes];
+        if (!owned) return false;
+        std::memset(owned, 0, bytes);
+        set_memory(owned, bytes);
+        init_header(count);
+        return true;
+    }
+
+    // Attach to the shared segment called name, creating it with about mb
+    // megabytes if it does not exist yet. A segment made by another process
+    // keeps its size. Returns false if it cannot be mapped or is not a table.
+    bool attach_shared(const std::string &name, size_t mb) {
+        release();
+        std::string segment = name.empty() || name[0] == '/' ? name : "/" + name;
+        size_t count = slot_count(mb);
+        size_t bytes = sizeof(Header) + count * sizeof(Slot);
+        bool created = false;
+#ifdef _WIN32
+        map_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                        static_cast<DWORD>(bytes), segment.c_str() + 1);
+        if (!map_handle) return false;
+        created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+        void *view = MapViewOfFile(map_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (!view) {
+            release();
+            return false;
+        }
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(view, &info, sizeof(info));
+        if (!created) bytes = info.RegionSize;
+#else
+        int fd = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            created = true;
+            if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                ::close(fd);
+                shm_unlink(segment.c_str());
+                return false;
+            }
+        } else {
+            fd = shm_open(segment.c_str(), O_RDWR, 0600);
+            if (fd < 0) return false;
+
+            // The creator may not have sized it yet
+            struct stat st;
+            for (int tries = 0; fstat(fd, &st) == 0 && st.st_size == 0 && tries < 100; tries++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (st.st_size < static_cast<off_t>(sizeof(Header))) {
+                ::close(fd);
+                return false;
+            }
+            bytes = static_cast<size_t>(st.st_size);
+        }
+
+        void *view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+#endif
+        shared = true;
+        set_memory(static_cast<uint8_t *>(view), bytes);
+
+        if (created) {
+            init_header(count);
+        } else {
+            // Wait for the creator to publish the header, then check it
+            for (int tries = 0; header->ready.load(std::memory_order_acquire) == 0 && tries < 100; tries++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (header->ready.load(std::memory_order_acquire) == 0 || header->magic != MAGIC ||
+                header->version != VERSION || sizeof(Header) + header->slot_count * sizeof(Slot) > bytes) {
+                release();
+                return false;
+            }
+            mask = header->slot_count - 1;
+        }
+        return true;
+    }
+
+    // Wipes every entry, for every process sharing the table
+    void clear() {
+        if (!slots) return;
+        std::memset(static_cast<void *>(slots), 0, (mask + 1) * sizeof(Slot));
+    }
+
+    // Entries from earlier searches become the first to be replaced. The
+    // generation moves on at most once per GENERATION_MS however many
+    // searches start, so concurrent requests do not age each other's entries
+    // and the counter takes hours to wrap.
+    void new_search() {
+        if (!header) return;
+        int64_t slice = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch()).count() / GENERATION_MS;
+        int64_t last = header->slice.load(std::memory_order_relaxed);
+        if (slice != last && header->slice.compare_exchange_strong(last, slice, std::memory_order_relaxed)) {
+            header->generation.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool probe(uint64_t key, Entry &entry) const {
+        if (!slots) return false;
+        const Slot &slot = slots[key & mask];
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || data == 0) return false;
+
+        unpack(data, entry);
+        return true;
+    }
+
+    // A slot holding another position keeps it only if that one was searched
+    // deeper in the current search; the same position is always overwritten
+    void store(uint64_t key, const Entry &entry) {
+        if (!slots) return;
+        Slot &slot = slots[key & mask];
+        uint32_t generation = header->generation.load(std::memory_order_relaxed) & GENERATION_MASK;
+
+        uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+        uint64_t old_check = slot.check.load(std::memory_order_relaxed);
+        if ((old_check ^ old_data) != key && old_data != 0 &&
+            ((old_data >> 50) & GENERATION_MASK) == generation &&
+            packed_depth(old_data) > entry.depth) {
+            return;
+        }
+
+        uint64_t data = pack(entry, generation);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    // Calls f(key, data) for every stored entry, data as packed by pack()
+    template <typename F> void for_each(F f) const {
+        for (size_t i = 0; slots && i <= mask; i++) {
+            uint64_t data = slots[i].data.load(std::memory_order_relaxed);
+            uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+            if (data != 0) f(check ^ data, data);
+        }
+    }
+
+    // eval 24 bits, move 16, depth 8, bound 2, generation 13, used 1
+    static uint64_t pack(const Entry &entry, uint32_t generation) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(entry.eval)) & 0xffffff) |
+               static_cast<uint64_t>(entry.best_move) << 24 |
+               static_cast<uint64_t>(entry.depth & 0xff) << 40 |
+               static_cast<uint64_t>(entry.node_type & 0x03) << 48 |
+               static_cast<uint64_t>(generation & GENERATION_MASK) << 50 |
+               USED;
+    }
+
+    static void unpack(uint64_t data, Entry &entry) {
+        // sign-extends the 24-bit eval
+        entry.eval = static_cast<int32_t>(static_cast<uint32_t>(data) << 8) >> 8;
+        entry.best_move = static_cast<uint16_t>(data >> 24);
+        entry.depth = static_cast<int>((data >> 40) & 0xff);
+        entry.node_type = static_cast<int>((data >> 48) & 0x03);
+    }
+
+    static int packed_depth(uint64_t data) {
+        return static_cast<int>((data >> 40) & 0xff);
+    }
+
+    bool is_allocated() const { return slots != nullptr; }
+    bool is_shared() const { return shared; }
+    size_t entries() const { return slots ? mask + 1 : 0; }
+    size_t size_mb() const { return entries() * sizeof(Slot) >> 20; }
+
+    // Unmaps or frees the table. A shared segment stays in place for the
+    // other processes until the host reboots or it is unlinked.
+    void release() {
+        if (shared && memory) {
+#ifdef _WIN32
+            UnmapViewOfFile(memory);
+            if (map_handle) CloseHandle(map_handle);
+#else
+            munmap(memory, memory_size);
+#endif
+        }
+#ifdef _WIN32
+        if (map_handle && !memory) CloseHandle(map_handle);
+        map_handle = nullptr;
+#endif
+        delete[] owned;
+        owned = nullptr;
+        memory = nullptr;
+        memory_size = 0;
+        header = nullptr;
+        slots = nullptr;
+        mask = 0;
+        shared = false;
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x31305454; // "TT01"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t GENERATION_MASK = 0x1fff;
+    static constexpr int64_t GENERATION_MS = 1000;
+    static constexpr uint64_t USED = 1ull << 63; // set in every stored entry, an empty slot is all zeros
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t slot_count;
+        std::atomic<uint32_t> generation;
+        std::atomic<uint32_t> ready;
+        std::atomic<int64_t> slice; // GENERATION_MS period of the last generation bump
+        uint8_t padding[32];        // keeps the slots cache-line aligned
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    static_assert(sizeof(Header) == 64, "the header should take one cache line");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "slots must be usable across processes");
+
+    // Largest power of two number of slots that fits in mb megabytes
+    static size_t slot_count(size_t mb) {
+        size_t bytes = (mb ? mb : 1) << 20;
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= bytes) count *= 2;
+        return count;
+    }
+
+    void set_memory(uint8_t *bytes, size_t size) {
+        memory = bytes;
+        memory_size = size;
+        header = reinterpret_cast<Header *>(bytes);
+        slots = reinterpret_cast<Slot *>(bytes + sizeof(Header));
+    }
+
+    void init_header(size_t count) {
+        header->magic = MAGIC;
+        header->version = VERSION;
+        header->slot_count = count;
+        header->generation.store(0, std::memory_order_relaxed);
+        header->slice.store(0, std::memory_order_relaxed);
+        mask = count - 1;
+        header->ready.store(1, std::memory_order_release);
+    }
+
+    uint8_t *owned = nullptr;
+    uint8_t *memory = nullptr;
+    size_t memory_size = 0;
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    size_t mask = 0;
+    bool shared = false;
+#ifdef _WIN32
+    HANDLE map_handle = nullptr;
+#endif
+};
+
+}  // namespace tt
@@ -0,0 +1,215 @@
+// tt_snapshot.h
+#pragma once
+#include "mapped_file.h"
+#include "transposition_table.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace tt {
+
+// Transposition table entries saved to disk so a restarted engine starts
+// warm. The file is a hash table image probed straight from a read-only
+// mapping, so loading only reads the header and pages come in as the search
+// touches them. Every block of slots has its own checksum, checked the first
+// time a probe lands in it; a corrupt block reads as empty.
+//
+// Layout, native byte order:
+//   Header (64 bytes)
+//   uint64_t block checksums[block_count]
+//   Record slots[slot_count], indexed by key & (slot_count - 1), empty = zeros
+class Snapshot {
+public:
+    static constexpr uint32_t MAGIC = 0x53545456; // "VTTS"
+    static constexpr uint32_t VERSION = 2; // 2: 24-bit eval, 13-bit generation
+    static constexpr uint32_t BLOCK_SLOTS = 4096;
+
+    // Writes the entries of table and of the loaded snapshot searched to at
+    // least min_depth; on the same key the live table wins. The file is
+    // written next to path and renamed over it, so concurrent writers and
+    // readers never see half a file. Returns the entries written, -1 on error.
+    long long save(const std::string &path, const Table &table, int min_depth) const {
+        std::vector<Record> records;
+        for_each([&](uint64_t key, uint64_t data) {
+            if (Table::packed_depth(data) >= min_depth) records.push_back({key, data});
+        });
+        table.for_each([&](uint64_t key, uint64_t data) {
+            if (Table::packed_depth(data) >= min_depth) records.push_back({key, data});
+        });
+
+        // Power of two with room to spare, so few entries are lost to collisions
+        uint64_t slot_count = BLOCK_SLOTS;
+        while (slot_count < records.size() * 2) slot_count *= 2;
+        std::vector<Record> slots(slot_count, Record{0, 0});
+        long long written = 0;
+        for (const Record &record : records) {
+            Record &slot = slots[record.key & (slot_count - 1)];
+            if (slot.data == 0) {
+                written++;
+            } else if (slot.key != record.key &&
+                       Table::packed_depth(slot.data) > Table::packed_depth(record.data)) {
+                continue;
+            }
+            slot = record;
+        }
+
+        uint64_t block_count = slot_count / BLOCK_SLOTS;
+        std::vector<uint64_t> checksums(block_count);
+        for (uint64_t b = 0; b < block_count; b++) {
+            checksums[b] = checksum(reinterpret_cast<const uint8_t *>(&slots[b * BLOCK_SLOTS]), BLOCK_SLOTS * sizeof(Record));
+        }
+
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.slot_count = slot_count;
+        header.block_slots = BLOCK_SLOTS;
+        header.min_depth = static_cast<uint32_t>(min_depth);
+        header.entry_count = static_cast<uint64_t>(written);
+        header.header_checksum = header_checksum(header);
+
+#ifdef _WIN32
+        std::string temp = path + ".tmp";
+#else
+        std::string temp = path + ".tmp" + std::to_string(getpid());
+#endif
+        FILE *file = std::fopen(temp.c_str(), "wb");
+        if (!file) return -1;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(checksums.data(), sizeof(uint64_t), block_count, file) == block_count &&
+                  std::fwrite(slots.data(), sizeof(Record), slot_count, file) == slot_count;
+        ok = std::fclose(file) == 0 && ok;
+        if (ok) {
+#ifdef _WIN32
+            std::remove(path.c_str());
+#endif
+            ok = std::rename(temp.c_str(), path.c_str()) == 0;
+        }
+        if (!ok) {
+            std::remove(temp.c_str());
+            return -1;
+        }
+        return written;
+    }
+
+    // Maps a snapshot file. Only the header and its checksum are read here.
+    bool load(const std::string &path) {
+        unload();
+        if (!file.open(path) || file.size() < sizeof(Header)) {
+            unload();
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        uint64_t block_count = header.block_slots ? header.slot_count / header.block_slots : 0;
+        if (header.magic != MAGIC || header.version != VERSION || header.header_checksum != header_checksum(header) ||
+            header.block_slots != BLOCK_SLOTS || header.slot_count == 0 ||
+            (header.slot_count & (header.slot_count - 1)) != 0 || header.slot_count % BLOCK_SLOTS != 0 ||
+            file.size() != sizeof(Header) + block_count * sizeof(uint64_t) + header.slot_count * sizeof(Record)) {
+            unload();
+            return false;
+        }
+
+        checksums = reinterpret_cast<const uint64_t *>(file.data() + sizeof(Header));
+        slots = reinterpret_cast<const Record *>(file.data() + sizeof(Header) + block_count * sizeof(uint64_t));
+        mask = header.slot_count - 1;
+        entry_count = header.entry_count;
+        block_state.reset(new std::atomic<uint8_t>[block_count]);
+        for (uint64_t b = 0; b < block_count; b++) block_state[b].store(UNCHECKED, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unload() {
+        file.close();
+        checksums = nullptr;
+        slots = nullptr;
+        mask = 0;
+        entry_count = 0;
+        block_state.reset();
+    }
+
+    bool probe(uint64_t key, Entry &entry) const {
+        if (!slots) return false;
+        uint64_t index = key & mask;
+        if (!block_valid(index / BLOCK_SLOTS)) return false;
+        const Record &slot = slots[index];
+        if (slot.key != key || slot.data == 0) return false;
+        Table::unpack(slot.data, entry);
+        return true;
+    }
+
+    bool is_loaded() const { return slots != nullptr; }
+    uint64_t entries() const { return entry_count; }
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t slot_count;
+        uint32_t block_slots;
+        uint32_t min_depth;
+        uint64_t entry_count;
+        uint64_t header_checksum; // of the fields above
+        uint8_t padding[24];
+    };
+
+    struct Record {
+        uint64_t key;
+        uint64_t data; // packed as by Table::pack
+    };
+
+    static_assert(sizeof(Header) == 64, "the snapshot header is 64 bytes");
+    static_assert(sizeof(Record) == 16, "snapshot records are 16 bytes");
+
+    enum : uint8_t { UNCHECKED = 0, VALID = 1, CORRUPT = 2 };
+
+    // FNV-1a over 64-bit words
+    static uint64_t checksum(const uint8_t *bytes, size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static uint64_t header_checksum(const Header &header) {
+        return checksum(reinterpret_cast<const uint8_t *>(&header), offsetof(Header, header_checksum));
+    }
+
+    template <typename F> void for_each(F f) const {
+        for (uint64_t i = 0; slots && i <= mask; i++) {
+            if (slots[i].data != 0 && block_valid(i / BLOCK_SLOTS)) f(slots[i].key, slots[i].data);
+        }
+    }
+
+    bool block_valid(uint64_t block) const {
+        uint8_t state = block_state[block].load(std::memory_order_relaxed);
+        if (state == UNCHECKED) {
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(slots + block * BLOCK_SLOTS);
+            state = checksum(bytes, BLOCK_SLOTS * sizeof(Record)) == checksums[block] ? VALID : CORRUPT;
+            block_state[block].store(state, std::memory_order_relaxed);
+        }
+        return state == VALID;
+    }
+
+    mapped_file::MappedFile file;
+    const uint64_t *checksums = nullptr;
+    const Record *slots = nullptr;
+    uint64_t mask = 0;
+    uint64_t entry_count = 0;
+    std::unique_ptr<std::atomic<uint8_t>[]> block_state;
+};
+
+}  // namespace tt
@@ -27,6 +27,7 @@ SOFTWARE.
 #define VIRGO_H
 
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 #include <regex>
 #include <iostream>
@@ -47,6 +48,12 @@ namespace {
     uint64_t FROM_TO_MASK[64][64];
     uint64_t LINE_MASK[64][64];
 
+    // Zobrist keys (filled by virgo_init)
+    uint64_t ZOBRIST_PIECE[2][6][64];
+    uint64_t ZOBRIST_CASTLE[16];
+    uint64_t ZOBRIST_ENPASSANT[65];
+    uint64_t ZOBRIST_SIDE;
+
     const uint64_t DEBRUIJN_MAGIC = 0x03f79d71b4cb0a89ull;
     const uint8_t DEBRUIJN_INDICES[64] = {
             0, 47,  1, 56, 48, 27,  2, 60,
@@ -246,26 +253,57 @@ namespace virgo {
         S_EAST
     };
 
+    // Undo information of a move, packed into 24 bytes
     typedef struct HistoryMove {
-        Piece capture;
+        uint8_t capture;
         uint16_t move;
-        unsigned int fifty_mv_counter = 0;
-        uint64_t enpassant = INVALID;
+        uint8_t fifty_mv_counter = 0;
+        uint8_t enpassant = INVALID;
         uint8_t castling_perm = 0;
+        uint64_t key = 0;
+        uint64_t pawn_key = 0;
     } HistoryMove;
 
+    // Maximum number of moves that can be taken back
+    constexpr unsigned int HISTORY_CAPACITY = 1024;
+
+    // Piece and owner of a board square
+    typedef struct SquareState {
+        Piece first;
+        Player second;
+    } SquareState;
+
+    // Squares attacked by each piece type of both players, pinned pieces and checkers of a position
+    typedef struct AttackInfo {
+        uint64_t by_piece[2][6];   // squares attacked by every piece of that type and player
+        uint64_t by_player[2];     // union of by_piece for each player
+        uint64_t pinned[2];        // pieces of each player absolutely pinned to their own king
+        uint64_t checkers;         // enemy pieces checking the king of the player to move
+        uint64_t king_danger;      // squares the king of the player to move can't step to
+    } AttackInfo;
+
+    // Mailbox encoding of a square: player << 3 | piece, an empty square is just EMPTY
+    inline uint8_t square_code(Player player, Piece piece) {
+        return static_cast<uint8_t>(player << 3 | piece);
+    }
+
     // Class maintaining information about the current board configuration
     class Chessboard {
     public:
         Chessboard();
-        Chessboard(Chessboard const &c);
 
-        std::pair<Piece, Player> & operator[] (unsigned int square) {
-            return this->squares[square];
+        SquareState operator[] (unsigned int square) const {
+            return {piece_on(square), color_on(square)};
         }
 
-        const std::pair<Piece, Player> & operator[] (unsigned int square) const {
-            return this->squares[square];
+        // It returns the piece on the given square (EMPTY if there is none)
+        inline Piece piece_on(unsigned int square) const {
+            return static_cast<Piece>(this->squares[square] & 0x07);
+        }
+
+        // It returns the owner of the piece on the given square (BLACK for an empty square)
+        inline Player color_on(unsigned int square) const {
+            return static_cast<Player>(this->squares[square] >> 3);
         }
 
         // Given a piece type and a player, it returns the corresponding bitboard
@@ -291,7 +329,37 @@ namespace virgo {
 
         // It returns the next player who has to make the next move
         inline Player get_next_to_move() {
-            return this->next;
+            return static_cast<Player>(this->next);
+        }
+
+        // It returns the current en-passant square (INVALID if it isn't set)
+        inline unsigned int get_enpassant() {
+            return this->enpassant;
+        }
+
+        // It returns the number of plies since the last capture or pawn move
+        inline unsigned int get_fifty_mv_counter() {
+            return this->fifty_mv_counter;
+        }
+
+        // It returns the Zobrist key of the position
+        inline uint64_t get_key() {
+            return this->key;
+        }
+
+        // It returns the Zobrist key of the pawns only
+        inline uint64_t get_pawn_key() {
+            return this->pawn_key;
+        }
+
+        // It returns the number of moves that can be taken back
+        inline unsigned int get_history_size() const {
+            return this->history_size;
+        }
+
+        // It returns the Zobrist key of the position plies_ago plies back (1 <= plies_ago <= history size)
+        inline uint64_t get_history_key(unsigned int plies_ago) const {
+            return this->history[this->history_size - plies_ago].key;
         }
 
         // It returns true if player P can castle king side otherwise false
@@ -315,12 +383,29 @@ namespace virgo {
         // It moves a piece from the "from" square to the "to" square
         void move_piece(unsigned int from, unsigned int to);
 
-        // Player who has to make the next move
-        Player next;
+        // It computes the Zobrist keys from scratch
+        void compute_keys();
+
+        // The position itself comes first and takes exactly three cache lines,
+        // the history only gets touched by make_move and take_move. Copying a
+        // board still copies the whole history, about 24 KB, so the search
+        // makes and takes back moves on one board instead of copying it.
+
+        // One bitboard for each piece type and color
+        uint64_t pieces[2][6];
+
+        // Black pieces | White pieces together
+        uint64_t all;
 
-        // History move array
-        std::vector<HistoryMove> history;
-        unsigned int ply;
+        // Zobrist keys of the whole position and of the pawns only
+        uint64_t key;
+        uint64_t pawn_key;
+
+        // Fast lookup for piece and color for each board square, one byte per square (see square_code)
+        uint8_t squares[64];
+
+        // Player who has to make the next move
+        uint8_t next;
 
         // Castling permissions bits B0000KQkq (0x0f = full permissions)
         uint8_t castling_perm;
@@ -329,27 +414,31 @@ namespace virgo {
         uint8_t fifty_mv_counter;
 
         // Current enpassant square (from 0 to 63, 64 if it isn't set)
-        unsigned int enpassant;
+        uint8_t enpassant;
 
         // Black and white king positions for fast lookup
-        unsigned int king_position[2];
-
-        // Black pieces | White pieces together
-        uint64_t all;
+        uint8_t king_position[2];
 
-        // One bitboard for each piece type and color
-        uint64_t pieces[2][6];
+        // Number of moves in the history, which is also the ply since the position was set up
+        uint16_t history_size;
 
-        // Fast lookup for piece and color for each board square
-        std::pair<Piece, Player> squares[64];
+        // History move array, kept inline so copying a board is a plain memcpy
+        HistoryMove history[HISTORY_CAPACITY];
 
         // Friends functions
         template <Player player> friend void get_legal_moves(Chessboard & board, std::vector<uint16_t> & mvs);
+        template <Player player> friend void get_legal_moves(Chessboard & board, const AttackInfo & info, std::vector<uint16_t> & mvs);
         template <Player player> friend void make_move(uint16_t move, Chessboard & board);
         template <Player player> friend void take_move(Chessboard & board);
+        friend void make_null_move(Chessboard & board);
+        friend void take_null_move(Chessboard & board);
         friend Chessboard position_from_fen(std::string fen);
     };
 
+    static_assert(std::is_trivially_copyable<Chessboard>::value, "Chessboard must stay trivially copyable");
+    static_assert(sizeof(HistoryMove) == 24, "HistoryMove should stay packed");
+    static_assert(sizeof(Chessboard) == 3 * 64 + HISTORY_CAPACITY * sizeof(HistoryMove), "Three cache lines of position, then the history");
+
     // Given a FEN chess game representation it returns an equivalent, initialized Chessboard
     Chessboard position_from_fen(std::string fen);
 
@@ -359,9 +448,21 @@ namespace virgo {
     // Given an encoded uint32_t move and a Chessboard object it makes the move
     template <Player player> bool make_move(uint32_t move, Chessboard & board);
 
+    // Given a Chessboard object it passes the turn to the other player
+    void make_null_move(Chessboard & board);
+
+    // Given a Chessboard object it reverts the latest null move
+    void take_null_move(Chessboard & board);
+
     // Given a Chessboard object and an empty vector of uint32 it returns every legal move for the current (next to move) player
     template <Player player> void get_legal_moves(Chessboard & board, std::vector<uint32_t> & moves);
 
+    // Same as above, reusing the attack information of the position already computed by get_attack_info
+    template <Player player> void get_legal_moves(Chessboard & board, const AttackInfo & info, std::vector<uint16_t> & mvs);
+
+    // Given a Chessboard object it fills info with its attack maps, pins and the checkers of player's king
+    template <Player player> void get_attack_info(Chessboard & board, AttackInfo & info);
+
     // It initializes Virgo's Kindergarten lookup tables
     void virgo_init();
 }
@@ -581,7 +682,7 @@ namespace {
 
             while(pieces) {
                 unsigned int square = bit::pop_lsb_index(pieces);
-                switch (board[square].first) {
+                switch (board.piece_on(square)) {
                     case KNIGHT:
                         danger |= KNIGHT_ATTACKS[square];
                         break;
@@ -599,6 +700,67 @@ namespace {
             }
             return danger;
         }
+
+        // Given a player and a board it fills the attacked squares of every piece type of that player
+        template <Player P> void fill_attacks(uint64_t all_bb, Chessboard & board, AttackInfo & info) {
+            uint64_t pieces = board.get_bitboard<P>(PAWN);
+            info.by_piece[P][PAWN] = getPawnsAttacks<P>(pieces);
+            info.by_piece[P][KING] = KING_ATTACKS[board.king_square<P>()];
+
+            uint64_t danger = 0ull;
+            for(pieces = board.get_bitboard<P>(KNIGHT); pieces; pieces &= (pieces-1))
+                danger |= KNIGHT_ATTACKS[bit::pop_lsb_index(pieces)];
+            info.by_piece[P][KNIGHT] = danger;
+
+            danger = 0ull;
+            for(pieces = board.get_bitboard<P>(BISHOP); pieces; pieces &= (pieces-1))
+                danger |= diagonal_attacks(all_bb, bit::pop_lsb_index(pieces));
+            info.by_piece[P][BISHOP] = danger;
+
+            danger = 0ull;
+            for(pieces = board.get_bitboard<P>(ROOK); pieces; pieces &= (pieces-1))
+                danger |= orthogonal_attacks(all_bb, bit::pop_lsb_index(pieces));
+            info.by_piece[P][ROOK] = danger;
+
+            danger = 0ull;
+            for(pieces = board.get_bitboard<P>(QUEEN); pieces; pieces &= (pieces-1)) {
+                unsigned int square = bit::pop_lsb_index(pieces);
+                danger |= diagonal_attacks(all_bb, square) | orthogonal_attacks(all_bb, square);
+            }
+            info.by_piece[P][QUEEN] = danger;
+
+            info.by_player[P] = info.by_piece[P][PAWN] | info.by_piece[P][ROOK] | info.by_piece[P][KNIGHT] |
+                                info.by_piece[P][BISHOP] | info.by_piece[P][KING] | info.by_piece[P][QUEEN];
+        }
+
+        // Given a player and a board it returns the player's pieces pinned to his king, the enemy
+        // sliding pieces checking the king are stored into checkers
+        template <Player P> uint64_t get_pinned(Chessboard & board, uint64_t & checkers) {
+            constexpr Player enemy = static_cast<Player>(P ^ 1);
+            unsigned int king_square = board.king_square<P>();
+            uint64_t enemy_bb = board.occupancy<enemy>();
+            uint64_t enemy_queen_bb = board.get_bitboard<enemy>(QUEEN);
+
+            // Remove the player's king to avoid problems with FROM_TO_MASK
+            uint64_t player_bb = board.occupancy<P>() ^ SQUARE_MASK[king_square];
+
+            // Enemy sliding pieces aligned with the player's king
+            uint64_t sliders = (orthogonal_attacks(enemy_bb, king_square) & (board.get_bitboard<enemy>(ROOK) | enemy_queen_bb)) |
+                               (diagonal_attacks(enemy_bb, king_square) & (board.get_bitboard<enemy>(BISHOP) | enemy_queen_bb));
+
+            uint64_t pinned = 0ull;
+            checkers = 0ull;
+            while(sliders) {
+                unsigned int sliding_piece_square = bit::pop_lsb_index(sliders);
+                uint64_t between = FROM_TO_MASK[king_square][sliding_piece_square] & player_bb;
+
+                // no pieces in between means check, exactly one of the player's pieces means a pin
+                if(between == 0) checkers |= SQUARE_MASK[sliding_piece_square];
+                else if((between & (between-1)) == 0) pinned |= between;
+                sliders &= (sliders-1);
+            }
+            return pinned;
+        }
     }
 }
 
@@ -607,6 +769,9 @@ namespace virgo {
     // Default constructor which initializes to the initial chess configuration
     Chessboard::Chessboard() {
         // Initial chessboard setup
+        this->history_size = 0;
+        this->key = 0;
+        this->pawn_key = 0;
         this->castling_perm = 0x00;
         this->fifty_mv_counter = 0;
         this->next = WHITE;
@@ -635,42 +800,24 @@ namespace virgo {
 
         // Fill with empty values
         for(int s = a1; s <= h8; s++) {
-            this->squares[s] = std::make_pair(EMPTY, BLACK);
+            this->squares[s] = EMPTY;
         }
 
         // Set every pair which has a piece on the corresponding square index
         for(int i = PAWN; i <= QUEEN; i++) {
             uint64_t board = this->pieces[BLACK][i];
             while(board) {
-                this->squares[bit::pop_lsb_index(board)] = std::make_pair(static_cast<Piece>(i), BLACK);
+                this->squares[bit::pop_lsb_index(board)] = square_code(BLACK, static_cast<Piece>(i));
                 board &= (board-1);
             }
             board = this->pieces[WHITE][i];
             while(board) {
-                this->squares[bit::pop_lsb_index(board)] = std::make_pair(static_cast<Piece>(i), WHITE);
+                this->squares[bit::pop_lsb_index(board)] = square_code(WHITE, static_cast<Piece>(i));
                 board &= (board-1);
             }
         }
     }
 
-    // Copy constructor
-    Chessboard::Chessboard(Chessboard const &c) {
-        this->all = c.all;
-        this->castling_perm = c.castling_perm;
-        this->fifty_mv_counter = c.fifty_mv_counter;
-        this->next = c.next;
-        this->enpassant = c.enpassant;
-
-        memcpy(this->pieces, c.pieces, 12*sizeof(uint64_t));
-
-        for(int s = a1; s <= h8; s++) {
-            this->squares[s] = c.squares[s];
-        }
-
-        this->king_position[0] = c.king_position[0];
-        this->king_position[1] = c.king_position[1];
-    }
-
     // Chessboard console format
     inline std::ostream & operator << (std::ostream & output, const Chessboard & board){
         static uint8_t pieceIcons[12] = {'p', 'r', 'n', 'b', 'k', 'q', 'P', 'R', 'N', 'B', 'K', 'Q'};
@@ -682,7 +829,7 @@ namespace virgo {
             grid.push_back('8' - row);
             grid.append("   | ");
             for (int file = 0; file < 8; file++) {
-                std::pair<Piece, Player> p = board[file + (7-row) * 8];
+                SquareState p = board[file + (7-row) * 8];
                 if(p.first == EMPTY) grid.push_back(' ');
                 else grid.push_back(pieceIcons[p.second * 6 + p.first]);
                 grid.append(" | ");
@@ -719,7 +866,7 @@ namespace virgo {
         Chessboard board = {};
         memset(board.pieces, 0ull, sizeof(board.pieces));
         board.castling_perm = 0x00;
-        for(int s = a1; s <= h8; s++) board.squares[s] = std::make_pair(EMPTY, BLACK);
+        for(int s = a1; s <= h8; s++) board.squares[s] = EMPTY;
 
 
         // take just the board representation
@@ -750,7 +897,7 @@ namespace virgo {
                 int color = std::isupper(static_cast<unsigned char>(c)) ? WHITE : BLACK;
 
                 board.pieces[color][indexes.at(std::tolower(c))] |= 1ull << square;
-                board.squares[square++] = std::make_pair(indexes.at(std::tolower(c)), static_cast<Player>(color));
+                board.squares[square++] = square_code(static_cast<Player>(color), indexes.at(std::tolower(c)));
 
                 rowSum++;
             }
@@ -766,8 +913,8 @@ namespace virgo {
         }
 
         board.all = board.occupancy<WHITE>() | board.occupancy<BLACK>();
-        board.king_position[0] = static_cast<Square>(bit::pop_lsb_index(board.pieces[0][KING]));
-        board.king_position[1] = static_cast<Square>(bit::pop_lsb_index(board.pieces[1][KING]));
+        board.king_position[0] = bit::pop_lsb_index(board.pieces[0][KING]);
+        board.king_position[1] = bit::pop_lsb_index(board.pieces[1][KING]);
 
         // Take the rest of the string
         std::string rest = fen.substr(fen.find(' ') + 1);
@@ -812,6 +959,8 @@ namespace virgo {
         // Fifty move rule counter
         board.fifty_mv_counter = std::stoi(match.str(4));
 
+        board.compute_keys();
+
         return board;
     }
 
@@ -820,8 +969,7 @@ namespace virgo {
         static const int8_t EP_OFFSET[2] = { 8, -8 };
 
         // Get the last move made and remove it from the history
-        HistoryMove last = board.history.back();
-        board.history.pop_back();
+        const HistoryMove & last = board.history[--board.history_size];
 
         // Get the from and to square
         unsigned int from = MOVE_FROM(last.move),
@@ -832,7 +980,6 @@ namespace virgo {
         board.castling_perm = last.castling_perm;
         board.fifty_mv_counter = last.fifty_mv_counter;
         board.enpassant = last.enpassant;
-        board.ply--;
 
         // Revert the move based on what type it is
         switch (MOVE_TYPE(last.move)) {
@@ -859,7 +1006,7 @@ namespace virgo {
                 break;
             case CAPTURE:
                 board.move_piece(to, from);
-                board.add_piece(static_cast<Player>(player ^ 1), last.capture, to);
+                board.add_piece(static_cast<Player>(player ^ 1), static_cast<Piece>(last.capture), to);
                 break;
             case PQ_B:
             case PQ_R:
@@ -873,12 +1020,16 @@ namespace virgo {
             case PC_N:
             case PC_Q:
                 board.clear_piece(to);
-                board.add_piece(static_cast<Player>(player ^ 1), last.capture, to);
+                board.add_piece(static_cast<Player>(player ^ 1), static_cast<Piece>(last.capture), to);
                 board.add_piece(player, PAWN, from);
                 break;
             default:
                 board.move_piece(to, from);
         }
+
+        // Restore the keys saved before the move
+        board.key = last.key;
+        board.pawn_key = last.pawn_key;
     }
 
     // Given a player, a move and a chessboard it makes the move
@@ -890,7 +1041,11 @@ namespace virgo {
                 to = MOVE_TO(move);
 
         // Add the move and a set of board's variables which must be tracked
-        board.history.push_back({board[to].first, move, board.fifty_mv_counter, board.enpassant, board.castling_perm});
+        board.history[board.history_size++] = {static_cast<uint8_t>(board.piece_on(to)), move, board.fifty_mv_counter,
+                                               board.enpassant, board.castling_perm, board.key, board.pawn_key};
+
+        // Remove the castling and en-passant state from the key
+        board.key ^= ZOBRIST_CASTLE[board.castling_perm] ^ ZOBRIST_ENPASSANT[board.enpassant];
 
         // Set the en-passant square to null
         board.enpassant = INVALID;
@@ -995,13 +1150,76 @@ namespace virgo {
                 break;
         }
 
-        // Set the next player to move and increase the ply
-        board.next = static_cast<Player>(player ^ 1);
-        board.ply++;
+        // Add the new castling and en-passant state and flip the side to move
+        board.key ^= ZOBRIST_CASTLE[board.castling_perm] ^ ZOBRIST_ENPASSANT[board.enpassant] ^ ZOBRIST_SIDE;
+
+        // Set the next player to move
+        board.next = player ^ 1;
+    }
+
+    // Given a chessboard it passes the turn, keeping every piece in place
+    void make_null_move(Chessboard & board) {
+        // The null move is stored in the history as move 0
+        board.history[board.history_size++] = {EMPTY, 0, board.fifty_mv_counter,
+                                               board.enpassant, board.castling_perm, board.key, board.pawn_key};
+
+        // The en-passant square is lost after passing
+        board.key ^= ZOBRIST_ENPASSANT[board.enpassant] ^ ZOBRIST_SIDE;
+        board.enpassant = INVALID;
+
+        board.fifty_mv_counter++;
+        board.next ^= 1;
+    }
+
+    // Given a chessboard it reverts the latest null move
+    void take_null_move(Chessboard & board) {
+        const HistoryMove & last = board.history[--board.history_size];
+
+        board.next ^= 1;
+        board.fifty_mv_counter = last.fifty_mv_counter;
+        board.enpassant = last.enpassant;
+        board.key = last.key;
+    }
+
+    // Given a player to move and a chessboard it computes attack maps, pinned pieces and checkers once for the position
+    template <Player player> void get_attack_info(Chessboard & board, AttackInfo & info) {
+        constexpr Player enemy = static_cast<Player>(player ^ 1);
+        uint64_t all_bb = board.occupancy();
+        unsigned int player_king_square = board.king_square<player>();
+
+        moves::fill_attacks<WHITE>(all_bb, board, info);
+        moves::fill_attacks<BLACK>(all_bb, board, info);
+
+        uint64_t slider_checkers, unused;
+        info.pinned[player] = moves::get_pinned<player>(board, slider_checkers);
+        info.pinned[enemy] = moves::get_pinned<enemy>(board, unused);
+
+        // Add enemy pawns and knights which check the player's king
+        info.checkers = slider_checkers |
+                        (KNIGHT_ATTACKS[player_king_square] & board.get_bitboard<enemy>(KNIGHT)) |
+                        (moves::get_pawns_attacks_to<enemy>(player_king_square) & board.get_bitboard<enemy>(PAWN));
+
+        // A sliding checker keeps attacking the squares behind the king once it steps away
+        info.king_danger = info.by_player[enemy];
+        uint64_t without_king = all_bb ^ SQUARE_MASK[player_king_square];
+        while(slider_checkers) {
+            unsigned int square = bit::pop_lsb_index(slider_checkers);
+            Piece piece = board.piece_on(square);
+            if(piece != BISHOP) info.king_danger |= moves::orthogonal_attacks(without_king, square);
+            if(piece != ROOK) info.king_danger |= moves::diagonal_attacks(without_king, square);
+            slider_checkers &= (slider_checkers-1);
+        }
     }
 
     // Given a player, a chessboard and a list of moves it fills the list with every legal move possible
     template <Player player> void get_legal_moves(Chessboard & board, std::vector<uint16_t> & mvs) {
+        AttackInfo info;
+        get_attack_info<player>(board, info);
+        get_legal_moves<player>(board, info, mvs);
+    }
+
+    // Given a player, a chessboard, its attack information and a list of moves it fills the list with every legal move possible
+    template <Player player> void get_legal_moves(Chessboard & board, const AttackInfo & info, std::vector<uint16_t> & mvs) {
         const static int8_t OFFSET[2][4] = {{-8,-7,-9,-16}, {8,9,7,16}};
         static const uint64_t PAWN_SPECIAL_RANK_MASK[2] = {0x00ff000000000000, 0x000000000000ff00};
         static const uint64_t CASTLING_ATTACK_MASK[2] = { 0x0c00000000000000, 0x000000000000000c };
@@ -1020,7 +1238,6 @@ namespace virgo {
         // Define the occupancy bitboards for each player and its union
         uint64_t all_bb = board.occupancy();
         uint64_t enemy_bb = board.occupancy<enemy>();
-        uint64_t player_bb = board.occupancy<player>();
 
         // Find pawns and knights player's bitboards
         uint64_t player_pawns_bb = board.get_bitboard<player>(PAWN);
@@ -1029,63 +1246,16 @@ namespace virgo {
         // Find orthogonal and diagonal pieces bitboards
         uint64_t enemy_queen_bb = board.get_bitboard<enemy>(QUEEN);
         uint64_t enemy_orth_bb = board.get_bitboard<enemy>(ROOK) | enemy_queen_bb;
-        uint64_t enemy_diag_bb = board.get_bitboard<enemy>(BISHOP) | enemy_queen_bb;
 
         uint64_t player_queen_bb = board.get_bitboard<player>(QUEEN);
         uint64_t player_orth_bb = board.get_bitboard<player>(ROOK) | player_queen_bb;
         uint64_t player_diag_bb = board.get_bitboard<player>(BISHOP) | player_queen_bb;
 
-        // Add enemy pawns and knights which check the player's king
-        uint64_t checkers = (KNIGHT_ATTACKS[player_king_square] & board.get_bitboard<enemy>(KNIGHT)) |
-                            (moves::get_pawns_attacks_to<enemy>(player_king_square) & board.get_bitboard<enemy>(PAWN));
-
-        // Find enemy sliding pieces aligned with the player's king
-        b1 = ((moves::orthogonal_attacks(enemy_bb, player_king_square)) & enemy_orth_bb) |
-             ((moves::diagonal_attacks(enemy_bb, player_king_square)) & enemy_diag_bb);
-
-        // Initialize the pinned bitboard
-        uint64_t pinned = 0ull;
-
-        // Remove the player's king to avoid problems with FROM_TO_MASK at **
-        player_bb ^= SQUARE_MASK[player_king_square];
-
-        // Iterate through every enemy slider piece aligned with the player's king
-        while(b1) {
-            // take the enemy sliding piece position
-            unsigned int sliding_piece_square = bit::pop_lsb_index(b1);
-
-            // take every piece between the range
-            b2 = FROM_TO_MASK[player_king_square][sliding_piece_square] & player_bb;
-
-            // if there are no pieces it is a checker
-            if(b2 == 0) {
-                checkers |= SQUARE_MASK[sliding_piece_square];
-            }
-                // otherwise if there is just one player's piece it is an absolutely pinned piece
-            else if ((b2 & (b2-1)) == 0) {
-                pinned |= b2;
-            }
-            b1 &= (b1-1);
-        }
-
-        // Find not-pinned pieces
+        // Checkers, pinned pieces and the squares attacked by the enemy with the king out of the way
+        uint64_t checkers = info.checkers;
+        uint64_t pinned = info.pinned[player];
         uint64_t not_pinned = (~pinned);
-
-        // Add back the player's king
-        player_bb ^= SQUARE_MASK[player_king_square];
-
-        // get attacked squares by enemy pieces (without & not_enemy_pieces (it would make the program crash with some tests))
-        /*
-         * P - -
-         * - k -
-         * - - B
-         * in this case if we had done an and operation with not_enemy_pieces we would have got
-         * 0 - -
-         * - 1 -
-         * - - 1
-         * giving the possibility for the king to move safe to the pawn position when actually it isn't safe
-         */
-        uint64_t attacked_bb = moves::get_attack_bitboard<enemy>(all_bb ^ SQUARE_MASK[player_king_square], board);
+        uint64_t attacked_bb = info.king_danger;
         b1 = attacked_bb;
 
         // find squares which are not under attack and leave the king out of check
@@ -1115,7 +1285,7 @@ namespace virgo {
 
             // Find the square where the checking piece lies on and its type
             unsigned int checking_piece_square = bit::pop_lsb_index(checkers);
-            Piece checker_piece = board[checking_piece_square].first;
+            Piece checker_piece = board.piece_on(checking_piece_square);
 
             // If the checker has just double moved
             if(checker_piece == PAWN &&
@@ -1247,8 +1417,8 @@ namespace virgo {
             // Add every quiet or attack move which is aligned with the king from pinned pieces
             while(b1) {
                 square = bit::pop_lsb_index(b1);
-                if(board[square].first == BISHOP) b2 = moves::diagonal_attacks(all_bb, square);
-                else if(board[square].first == ROOK) b2 = moves::orthogonal_attacks(all_bb, square);
+                if(board.piece_on(square) == BISHOP) b2 = moves::diagonal_attacks(all_bb, square);
+                else if(board.piece_on(square) == ROOK) b2 = moves::orthogonal_attacks(all_bb, square);
                 else b2 = moves::diagonal_attacks(all_bb, square) | moves::orthogonal_attacks(all_bb, square);
                 b2 &= LINE_MASK[square][player_king_square];
                 b3 = b2 & (~all_bb);
@@ -1268,9 +1438,9 @@ namespace virgo {
             b1 = (player_diag_bb | player_orth_bb | player_knights_bb) & not_pinned;
             while(b1) {
                 square = bit::pop_lsb_index(b1);
-                if(board[square].first == BISHOP) b2 = moves::diagonal_attacks(all_bb, square);
-                else if(board[square].first == ROOK) b2 = moves::orthogonal_attacks(all_bb, square);
-                else if(board[square].first == QUEEN) b2 = moves::diagonal_attacks(all_bb, square) | moves::orthogonal_attacks(all_bb, square);
+                if(board.piece_on(square) == BISHOP) b2 = moves::diagonal_attacks(all_bb, square);
+                else if(board.piece_on(square) == ROOK) b2 = moves::orthogonal_attacks(all_bb, square);
+                else if(board.piece_on(square) == QUEEN) b2 = moves::diagonal_attacks(all_bb, square) | moves::orthogonal_attacks(all_bb, square);
                 else b2 = KNIGHT_ATTACKS[square];
                 b3 = b2 & (~all_bb);
                 while(b3) {
@@ -1431,39 +1601,60 @@ namespace virgo {
 
     // It moves a piece from the "from" square to the "to" square
     void Chessboard::move_piece(unsigned int from, unsigned int to) {
-        auto & f = this->squares[from];
-        auto & t = this->squares[to];
+        Piece piece = this->piece_on(from);
+        Player player = this->color_on(from);
 
-        this->pieces[f.second][f.first] &= ~(1ull << from);
+        this->pieces[player][piece] &= ~(1ull << from);
         this->all &= ~(1ull << from);
 
-        this->pieces[f.second][f.first] |= (1ull << to);
+        this->pieces[player][piece] |= (1ull << to);
         this->all |= (1ull << to);
 
-        t.first = f.first;
-        t.second = f.second;
-        f.first = EMPTY;
+        uint64_t delta = ZOBRIST_PIECE[player][piece][from] ^ ZOBRIST_PIECE[player][piece][to];
+        this->key ^= delta;
+        if(piece == PAWN) this->pawn_key ^= delta;
+
+        this->squares[to] = this->squares[from];
+        this->squares[from] = EMPTY;
 
-        if(t.first == KING) {
-            this->king_position[t.second] = to;
+        if(piece == KING) {
+            this->king_position[player] = to;
         }
     }
 
     // It wipes a piece from a given square
     void Chessboard::clear_piece(unsigned int square) {
-        auto & t = this->squares[square];
-        this->pieces[t.second][t.first] &= ~(1ull << square);
+        Piece piece = this->piece_on(square);
+        Player player = this->color_on(square);
+        this->pieces[player][piece] &= ~(1ull << square);
         this->all &= ~(1ull << square);
-        t.first = EMPTY;
+        this->key ^= ZOBRIST_PIECE[player][piece][square];
+        if(piece == PAWN) this->pawn_key ^= ZOBRIST_PIECE[player][piece][square];
+        this->squares[square] = EMPTY;
     }
 
     // It adds a new piece on to the given square
     void Chessboard::add_piece(Player player, Piece piece, unsigned int square) {
-        auto & t = this->squares[square];
-        t.first = piece;
-        t.second = player;
+        this->squares[square] = square_code(player, piece);
         this->pieces[player][piece] |= 1ull << square;
         this->all |= (1ull << square);
+        this->key ^= ZOBRIST_PIECE[player][piece][square];
+        if(piece == PAWN) this->pawn_key ^= ZOBRIST_PIECE[player][piece][square];
+    }
+
+    // It computes the Zobrist keys from scratch
+    void Chessboard::compute_keys() {
+        this->key = 0;
+        this->pawn_key = 0;
+        for(int s = a1; s <= h8; s++) {
+            Piece piece = this->piece_on(s);
+            if(piece == EMPTY) continue;
+            Player player = this->color_on(s);
+            this->key ^= ZOBRIST_PIECE[player][piece][s];
+            if(piece == PAWN) this->pawn_key ^= ZOBRIST_PIECE[player][piece][s];
+        }
+        this->key ^= ZOBRIST_CASTLE[this->castling_perm] ^ ZOBRIST_ENPASSANT[this->enpassant];
+        if(this->next == WHITE) this->key ^= ZOBRIST_SIDE;
     }
 
     // It initializes Virgo's lookup tables
@@ -1517,6 +1708,23 @@ namespace virgo {
                 }
             }
         }
+
+        // Zobrist keys init (xorshift64*, fixed seed so keys are stable across runs)
+        uint64_t seed = 0x9e3779b97f4a7c15ull;
+        auto next_random = [&seed]() {
+            seed ^= seed >> 12;
+            seed ^= seed << 25;
+            seed ^= seed >> 27;
+            return seed * 0x2545f4914f6cdd1dull;
+        };
+        for(auto & player : ZOBRIST_PIECE)
+            for(auto & piece : player)
+                for(auto & square : piece)
+                    square = next_random();
+        for(auto & castle : ZOBRIST_CASTLE) castle = next_random();
+        for(int s = 0; s < 64; s++) ZOBRIST_ENPASSANT[s] = next_random();
+        ZOBRIST_ENPASSANT[INVALID] = 0ull;
+        ZOBRIST_SIDE = next_random();
     }
 
 /////////////////////////////////////////////////////////////////////// TEST HELPERS ///////////////////////////////////////////////////////////////////////////////////
@@ -3,7 +3,7 @@ from fastapi.middleware.cors import CORSMiddleware
 from pydantic import BaseModel
 import chess
 from engine.engine_strong import get_best_move as get_best_move_python
-from engine.engine_strong_cpp import get_best_move
+from engine.engine_strong_cpp import get_best_move, analyse, load_book, load_tablebases, load_nnue, attach_shared_hash, set_hash_size, load_hash_snapshot, save_hash_snapshot, set_result_cache_size, result_cache_info, coalesce_info, set_search_threads, scheduler_info
 from engine.engine_connect5 import get_best_move as get_best_move_connect5
 import os
 import requests
@@ -16,6 +16,47 @@ OPENROUTER_KEY = os.environ.get("OPENROUTER_KEY")
 if not OPENROUTER_KEY:
     print("WARNING: OPENROUTER_KEY not set; /chat will return 500")
 
+BOOK_PATH = os.environ.get("BOOK_PATH")
+if BOOK_PATH and not load_book(BOOK_PATH):
+    print(f"WARNING: could not load opening book {BOOK_PATH}; searching every move")
+
+SYZYGY_PATH = os.environ.get("SYZYGY_PATH")
+SYZYGY_PIECES = int(os.environ.get("SYZYGY_PIECES", "5"))
+SYZYGY_PROBE_DEPTH = int(os.environ.get("SYZYGY_PROBE_DEPTH", "2"))
+if SYZYGY_PATH and not load_tablebases(SYZYGY_PATH, SYZYGY_PIECES, SYZYGY_PROBE_DEPTH):
+    print(f"WARNING: could not open tablebases at {SYZYGY_PATH}")
+
+# Every uvicorn worker attaches to the same table, so a game keeps a warm
+# hash whichever worker its next request lands on
+TT_SHARED_NAME = os.environ.get("TT_SHARED_NAME")
+TT_SIZE_MB = int(os.environ.get("TT_SIZE_MB", "16"))
+if TT_SHARED_NAME:
+    if not attach_shared_hash(TT_SHARED_NAME, TT_SIZE_MB):
+        print(f"WARNING: could not attach shared hash {TT_SHARED_NAME}; using a private table")
+else:
+    set_hash_size(TT_SIZE_MB)
+
+# Deep entries of the last run, so a restart doesn't search popular positions cold
+TT_SNAPSHOT_PATH = os.environ.get("TT_SNAPSHOT_PATH")
+TT_SNAPSHOT_DEPTH = int(os.environ.get("TT_SNAPSHOT_DEPTH", "4"))
+if TT_SNAPSHOT_PATH and os.path.exists(TT_SNAPSHOT_PATH) and not load_hash_snapshot(TT_SNAPSHOT_PATH):
+    print(f"WARNING: ignoring invalid hash snapshot {TT_SNAPSHOT_PATH}")
+
+# Finished searches reused across requests, mostly popular opening positions
+RESULT_CACHE_ENTRIES = os.environ.get("RESULT_CACHE_ENTRIES")
+if RESULT_CACHE_ENTRIES:
+    set_result_cache_size(int(RESULT_CACHE_ENTRIES))
+
+# Searches run on a native pool, earliest deadline first; requests beyond
+# its queue get a quick fallback move instead of waiting
+SEARCH_THREADS = int(os.environ.get("SEARCH_THREADS", "0"))
+SEARCH_QUEUE = int(os.environ.get("SEARCH_QUEUE", "0"))
+set_search_threads(SEARCH_THREADS, SEARCH_QUEUE)
+
+NNUE_PATH = os.environ.get("NNUE_PATH")
+if NNUE_PATH and not load_nnue(NNUE_PATH):
+    print(f"WARNING: could not load NNUE weights {NNUE_PATH}; using the classic evaluation")
+
 MODEL_CANDIDATES = [
     "deepseek/deepseek-chat-v3.1:free",
     "google/gemini-2.0-flash-exp:free",
@@ -35,10 +76,24 @@ app.add_middleware(
     allow_headers=["*"],
 )
 
+@app.on_event("shutdown")
+def save_snapshot():
+    if TT_SNAPSHOT_PATH:
+        save_hash_snapshot(TT_SNAPSHOT_PATH, TT_SNAPSHOT_DEPTH)
+
+
+# Limits on what one /bestmove request may ask of a search worker
+MAX_TIME_MS = 10000
+MAX_DEPTH = 64
+MAX_NODES = 5_000_000
+
 
 class Request(BaseModel):
     fen: str
     time_ms: int = 200
+    depth: int = 0
+    nodes: int = 0
+    skill: int = 20
 
 
 @app.post("/bestmove-python")
@@ -48,9 +103,27 @@ def bestmove(req: Request):
 
 @app.post("/bestmove")
 def bestmove(req: Request):
-    result = get_best_move(req.fen, req.time_ms)
+    time_ms = max(0, min(req.time_ms, MAX_TIME_MS))
+    depth = max(0, min(req.depth, MAX_DEPTH))
+    nodes = max(0, min(req.nodes, MAX_NODES))
+    skill = max(0, min(req.skill, 20))
+    result = get_best_move(req.fen, time_ms, depth, nodes, skill)
     return result
 
+@app.get("/stats")
+def stats():
+    return {"result_cache": result_cache_info(), "coalesced": coalesce_info(), "scheduler": scheduler_info()}
+
+class AnalyseRequest(BaseModel):
+    fen: str
+    time_ms: int = 1000
+    multipv: int = 3
+
+@app.post("/analyse")
+def analyse_position(req: AnalyseRequest):
+    multipv = max(1, min(req.multipv, 10))
+    return {"lines": analyse(req.fen, req.time_ms, multipv)}
+
 class ChatRequest(BaseModel):
     message: str
     fen: Optional[str] = None
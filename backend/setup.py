@@ -2,10 +2,22 @@
 from setuptools import setup, Extension
 import pybind11
 import os
+import sys
 
 engine_dir = os.path.abspath("engine")
 virgo_dir = os.path.join(engine_dir, "virgo")
 
+# SIMD level for the NNUE kernels (AVX2 / SSE4.1 / scalar). The default build
+# is portable; set ENGINE_MARCH (e.g. "native" or "x86-64-v3", or "AVX2" for
+# MSVC's /arch) only when the module runs on the machine it is built for
+march = os.environ.get("ENGINE_MARCH", "")
+if not march:
+    arch_flags = []
+elif sys.platform == "win32":
+    arch_flags = [f"/arch:{march}"]
+else:
+    arch_flags = [f"-march={march}"]
+
 ext_modules = [
     # Chess engine
     Extension(
@@ -18,7 +30,7 @@ ext_modules = [
             "-std=c++17",
             "-fexceptions",
             "-fno-omit-frame-pointer",
-        ],
+        ] + arch_flags,
     ),
 
     # Connect-Five engine